@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <source_location>
+#include <ulf/decup_ein.hpp>
+#include <zpp/zpp.hpp>
+
+namespace {
+
+std::span<uint8_t const> flash(size_t n) {
+  static auto const zpp_file{zpp::read(
+    std::filesystem::path{std::source_location::current().file_name()}
+      .parent_path() /
+    "../data/test.zpp")};
+  return std::span<uint8_t const>{zpp_file.flash}.first(
+    std::min(n, size(zpp_file.flash)));
+}
+
+void set_counters(benchmark::State& state, size_t bytes) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+} // namespace
+
+void crc8_decup(benchmark::State& state) {
+  auto const bytes{flash(static_cast<size_t>(state.range(0)))};
+  for (auto _ : state) benchmark::DoNotOptimize(decup::crc8(bytes, 0x55u));
+  set_counters(state, size(bytes));
+}
+BENCHMARK(crc8_decup)->Arg(4)->Arg(64)->Arg(256)->Arg(64 * 1024);
+
+void crc8_sliced(benchmark::State& state) {
+  auto const bytes{flash(static_cast<size_t>(state.range(0)))};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(ulf::decup_ein::crc8(bytes, 0x55u));
+  set_counters(state, size(bytes));
+}
+BENCHMARK(crc8_sliced)->Arg(4)->Arg(64)->Arg(256)->Arg(64 * 1024);
+
+void exor_decup(benchmark::State& state) {
+  auto const bytes{flash(static_cast<size_t>(state.range(0)))};
+  for (auto _ : state) benchmark::DoNotOptimize(decup::exor(bytes));
+  set_counters(state, size(bytes));
+}
+BENCHMARK(exor_decup)->Arg(32)->Arg(64)->Arg(256)->Arg(64 * 1024);
+
+void exor_word(benchmark::State& state) {
+  auto const bytes{flash(static_cast<size_t>(state.range(0)))};
+  for (auto _ : state) benchmark::DoNotOptimize(ulf::decup_ein::exor(bytes));
+  set_counters(state, size(bytes));
+}
+BENCHMARK(exor_word)->Arg(32)->Arg(64)->Arg(256)->Arg(64 * 1024);
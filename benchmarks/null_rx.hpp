@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ulf/decup_ein.hpp>
+
+// Backend which answers every transmission right away
+struct NullRx : ulf::decup_ein::rx::Base {
+  uint8_t pulse_count{2u};
+  size_t transmits{};
+
+private:
+  uint8_t transmit(std::span<uint8_t const>, uint32_t) final {
+    ++transmits;
+    return pulse_count;
+  }
+
+  void config(uint8_t) final {}
+};
+
+// Static dispatch backend which answers every transmission right away
+template<size_t BlockSize = 0uz>
+struct NullEngine
+  : ulf::decup_ein::rx::Engine<NullEngine<BlockSize>, BlockSize> {
+  uint8_t pulse_count{2u};
+  size_t transmits{};
+
+private:
+  friend ulf::decup_ein::rx::Engine<NullEngine<BlockSize>, BlockSize>;
+
+  uint8_t transmit(std::span<uint8_t const>, uint32_t) {
+    ++transmits;
+    return pulse_count;
+  }
+
+  void config(uint8_t) {}
+};
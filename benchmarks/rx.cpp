@@ -0,0 +1,294 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <ranges>
+#include <source_location>
+#include <vector>
+#include <zpp/zpp.hpp>
+#include <zsu/zsu.hpp>
+#include "null_rx.hpp"
+
+namespace {
+
+std::filesystem::path data_path() {
+  return std::filesystem::path{std::source_location::current().file_name()}
+           .parent_path() /
+         "../data";
+}
+
+zsu::Firmware const& zsu_firmware() {
+  static auto const zsu_file{zsu::read(data_path() / "DS240307.zsu")};
+  auto const it{
+    std::ranges::find(zsu_file.firmwares, 221u, &zsu::Firmware::id)};
+  return it != cend(zsu_file.firmwares) ? *it : zsu_file.firmwares.front();
+}
+
+zpp::File const& zpp_file() {
+  static auto const zpp_file{zpp::read(data_path() / "test.zpp")};
+  return zpp_file;
+}
+
+// ZSU blocks including block counter and XOR trailer
+std::vector<uint8_t> const& zsu_blocks_stream() {
+  static auto const stream{[] {
+    auto const& fw{zsu_firmware()};
+    std::vector<uint8_t> retval;
+    uint8_t count{0u};
+    for (auto chunk : fw.bin | std::views::chunk(decup::decoder_id2block_size(
+                                 static_cast<uint8_t>(fw.id)))) {
+      retval.push_back(count);
+      retval.insert(end(retval), begin(chunk), end(chunk));
+      retval.push_back(count++ ^ decup::exor(chunk));
+    }
+    return retval;
+  }()};
+  return stream;
+}
+
+// ZPP flash write packets
+std::vector<uint8_t> const& zpp_flash_write_stream() {
+  static auto const stream{[] {
+    std::vector<uint8_t> retval;
+    uint16_t block{0u};
+    for (auto chunk : zpp_file().flash | std::views::chunk(256u)) {
+      retval.insert(end(retval),
+                    {std::to_underlying(decup::Command::WriteFlash),
+                     0x55u,
+                     static_cast<uint8_t>(block >> 0u),
+                     static_cast<uint8_t>(block >> 8u)});
+      retval.insert(end(retval), begin(chunk), end(chunk));
+      retval.push_back(decup::crc8(chunk, 0x55u));
+      ++block;
+    }
+    return retval;
+  }()};
+  return stream;
+}
+
+// ZPP CV reads of CV 1-1024
+std::vector<uint8_t> const& zpp_cv_read_stream() {
+  static auto const stream{[] {
+    std::vector<uint8_t> retval;
+    for (uint16_t cv{0u}; cv < 1024u; ++cv) {
+      retval.insert(end(retval),
+                    {std::to_underlying(decup::Command::CvRead),
+                     static_cast<uint8_t>(cv >> 0u),
+                     static_cast<uint8_t>(cv >> 8u)});
+      retval.insert(end(retval), CHAR_BIT - 1uz, 0xFFu);
+    }
+    return retval;
+  }()};
+  return stream;
+}
+
+// Alternating preamble bytes
+std::vector<uint8_t> const& preamble_stream() {
+  static auto const stream{[] {
+    std::vector<uint8_t> retval(64uz * 1024uz);
+    for (auto i{0uz}; i < size(retval); ++i)
+      retval[i] = std::to_underlying(i % 3uz ? decup::Command::Preamble0
+                                             : decup::Command::Preamble1);
+    return retval;
+  }()};
+  return stream;
+}
+
+// Walk through ZSU states up to the first block
+template<typename Rx>
+void enter_zsu_blocks(Rx& rx) {
+  auto const& fw{zsu_firmware()};
+  rx.receive(std::to_underlying(decup::Command::Preamble0));
+  rx.receive(static_cast<uint8_t>(fw.id));
+  rx.pulse_count = 1u;
+  rx.receive(static_cast<uint8_t>(size(fw.bin) / 256u + 8u - 1u));
+  rx.receive(0x55u);
+  rx.receive(0xAAu);
+  rx.pulse_count = 2u;
+}
+
+// Receive stream either byte by byte (transfer size 0) or in transfers
+void receive(NullRx& rx, std::span<uint8_t const> stream, size_t transfer) {
+  if (!transfer) {
+    for (auto const byte : stream)
+      benchmark::DoNotOptimize(rx.receive(byte));
+    return;
+  }
+  std::vector<uint8_t> responses(transfer);
+  while (!empty(stream)) {
+    auto bytes{stream.first(std::min(transfer, size(stream)))};
+    stream = stream.subspan(size(bytes));
+    while (!empty(bytes)) {
+      auto const result{rx.receive(bytes, responses)};
+      benchmark::DoNotOptimize(responses.data());
+      bytes = bytes.subspan(result.in);
+    }
+  }
+}
+
+// Trace of ZSU blocks received in transfers of 64 bytes
+std::vector<uint8_t> const& zsu_blocks_trace() {
+  static auto const trace{[] {
+    std::vector<uint8_t> retval(4uz * 1024uz * 1024uz);
+    ulf::decup_ein::rx::Trace recorder{retval};
+    NullRx rx;
+    rx.trace(&recorder);
+    enter_zsu_blocks(rx);
+    receive(rx, zsu_blocks_stream(), 64uz);
+    retval.resize(size(recorder.data()));
+    return retval;
+  }()};
+  return trace;
+}
+
+void set_counters(benchmark::State& state, size_t bytes, size_t transmits) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+  state.counters["time_per_byte"] = benchmark::Counter(
+    static_cast<double>(bytes),
+    benchmark::Counter::kIsIterationInvariantRate |
+      benchmark::Counter::kInvert);
+  state.counters["transmits_per_MB"] =
+    static_cast<double>(transmits) * 1e6 / static_cast<double>(bytes);
+}
+
+} // namespace
+
+void zsu_blocks(benchmark::State& state) {
+  auto const& stream{zsu_blocks_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    NullRx rx;
+    enter_zsu_blocks(rx);
+    rx.transmits = 0uz;
+    state.ResumeTiming();
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(zsu_blocks)->Arg(0)->Arg(64)->Arg(512);
+
+void zpp_flash_write(benchmark::State& state) {
+  auto const& stream{zpp_flash_write_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullRx rx;
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(zpp_flash_write)->Arg(0)->Arg(64)->Arg(512);
+
+void zpp_cv_read(benchmark::State& state) {
+  auto const& stream{zpp_cv_read_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullRx rx;
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(zpp_cv_read)->Arg(0)->Arg(64);
+
+void preamble(benchmark::State& state) {
+  auto const& stream{preamble_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullRx rx;
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(preamble)->Arg(0)->Arg(64);
+
+void preamble_burst(benchmark::State& state) {
+  auto const& stream{preamble_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullRx rx;
+    rx.options({.preamble_burst = true});
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(preamble_burst)->Arg(64)->Arg(512);
+
+void zsu_blocks_traced(benchmark::State& state) {
+  auto const& stream{zsu_blocks_stream()};
+  std::vector<uint8_t> buffer(4uz * 1024uz * 1024uz);
+  ulf::decup_ein::rx::Trace trace{buffer};
+  size_t transmits{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    NullRx rx;
+    rx.trace(&trace);
+    enter_zsu_blocks(rx);
+    rx.transmits = 0uz;
+    trace.clear();
+    state.ResumeTiming();
+    receive(rx, stream, static_cast<size_t>(state.range(0)));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(zsu_blocks_traced)->Arg(0)->Arg(64)->Arg(512);
+
+void replay_zsu_blocks(benchmark::State& state) {
+  auto const& trace{zsu_blocks_trace()};
+  size_t mismatches{};
+  for (auto _ : state) {
+    ulf::decup_ein::rx::Replay replay{trace};
+    mismatches = replay.run();
+  }
+  state.SetBytesProcessed(
+    static_cast<int64_t>(state.iterations() * size(trace)));
+  state.counters["mismatches"] = static_cast<double>(mismatches);
+}
+BENCHMARK(replay_zsu_blocks);
+
+template<size_t BlockSize>
+void engine_zsu_blocks(benchmark::State& state) {
+  auto const& stream{zsu_blocks_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    NullEngine<BlockSize> rx;
+    enter_zsu_blocks(rx);
+    rx.transmits = 0uz;
+    state.ResumeTiming();
+    for (auto const byte : stream) benchmark::DoNotOptimize(rx.receive(byte));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(engine_zsu_blocks<0uz>);
+BENCHMARK(engine_zsu_blocks<64uz>);
+
+void engine_zpp_flash_write(benchmark::State& state) {
+  auto const& stream{zpp_flash_write_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullEngine rx;
+    for (auto const byte : stream) benchmark::DoNotOptimize(rx.receive(byte));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(engine_zpp_flash_write);
+
+void engine_zpp_cv_read(benchmark::State& state) {
+  auto const& stream{zpp_cv_read_stream()};
+  size_t transmits{};
+  for (auto _ : state) {
+    NullEngine rx;
+    for (auto const byte : stream) benchmark::DoNotOptimize(rx.receive(byte));
+    transmits = rx.transmits;
+  }
+  set_counters(state, size(stream), transmits);
+}
+BENCHMARK(engine_zpp_cv_read);
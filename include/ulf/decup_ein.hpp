@@ -11,5 +11,21 @@
 #pragma once
 
 #include "decup_ein/ack.hpp"
+#include "decup_ein/checksum.hpp"
 #include "decup_ein/nak.hpp"
+#include "decup_ein/rx/adaptive_timeouts.hpp"
+#include "decup_ein/rx/async_base.hpp"
 #include "decup_ein/rx/base.hpp"
+#include "decup_ein/rx/broadcast.hpp"
+#include "decup_ein/rx/config.hpp"
+#include "decup_ein/rx/engine.hpp"
+#include "decup_ein/rx/metrics.hpp"
+#include "decup_ein/rx/options.hpp"
+#include "decup_ein/rx/replay.hpp"
+#include "decup_ein/rx/serial.hpp"
+#include "decup_ein/rx/server.hpp"
+#include "decup_ein/rx/state.hpp"
+#include "decup_ein/rx/trace.hpp"
+#include "decup_ein/tx/session.hpp"
+#include "decup_ein/tx/zpp_session.hpp"
+#include "decup_ein/tx/zsu_session.hpp"
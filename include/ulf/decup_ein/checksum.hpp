@@ -0,0 +1,173 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Checksums
+///
+/// \file   ulf/decup_ein/checksum.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <decup/decup.hpp>
+#include <span>
+
+namespace ulf::decup_ein {
+
+namespace detail {
+
+/// CRC8 slicing tables
+///
+/// \details Table 0 is decup::crc8 for every byte, table n is table 0 applied
+/// n more times. Since CRC8 is linear, 4 bytes can then be processed with 4
+/// independent lookups.
+inline constexpr auto crc8_tables{[] {
+  std::array<std::array<uint8_t, 256uz>, 4uz> retval{};
+  for (auto i{0uz}; i < 256uz; ++i)
+    retval[0uz][i] = decup::crc8(static_cast<uint8_t>(i));
+  for (auto n{1uz}; n < size(retval); ++n)
+    for (auto i{0uz}; i < 256uz; ++i)
+      retval[n][i] = retval[0uz][retval[n - 1uz][i]];
+  return retval;
+}()};
+
+} // namespace detail
+
+/// Incremental CRC8
+///
+/// \details Equivalent to decup::crc8, but slices 4 bytes at a time. Can be
+/// fed as bytes arrive.
+class Crc8 {
+public:
+  /// Ctor
+  ///
+  /// \param  init  Initial value
+  constexpr explicit Crc8(uint8_t init = 0u) : _crc{init} {}
+
+  /// Update with single byte
+  ///
+  /// \param  byte  Byte
+  /// \return Reference to this
+  constexpr Crc8& update(uint8_t byte) {
+    _crc = detail::crc8_tables[0uz][_crc ^ byte];
+    return *this;
+  }
+
+  /// Update with bytes
+  ///
+  /// \param  bytes Bytes
+  /// \return Reference to this
+  constexpr Crc8& update(std::span<uint8_t const> bytes) {
+    auto const& t{detail::crc8_tables};
+    auto i{0uz};
+    for (; i + 4uz <= size(bytes); i += 4uz)
+      _crc = t[3uz][_crc ^ bytes[i + 0uz]] ^ t[2uz][bytes[i + 1uz]] ^
+             t[1uz][bytes[i + 2uz]] ^ t[0uz][bytes[i + 3uz]];
+    for (; i < size(bytes); ++i) update(bytes[i]);
+    return *this;
+  }
+
+  /// Get value
+  ///
+  /// \return CRC8
+  constexpr uint8_t value() const { return _crc; }
+
+private:
+  uint8_t _crc{};
+};
+
+/// Incremental XOR
+///
+/// \details Equivalent to decup::exor, but folds 8 bytes at a time. Can be fed
+/// as bytes arrive.
+class Exor {
+public:
+  /// Ctor
+  ///
+  /// \param  init  Initial value
+  constexpr explicit Exor(uint8_t init = 0u) : _exor{init} {}
+
+  /// Update with single byte
+  ///
+  /// \param  byte  Byte
+  /// \return Reference to this
+  constexpr Exor& update(uint8_t byte) {
+    _exor ^= byte;
+    return *this;
+  }
+
+  /// Update with bytes
+  ///
+  /// \param  bytes Bytes
+  /// \return Reference to this
+  constexpr Exor& update(std::span<uint8_t const> bytes) {
+    auto i{0uz};
+    if !consteval {
+      uint64_t word{};
+      for (; i + sizeof(word) <= size(bytes); i += sizeof(word)) {
+        uint64_t tmp;
+        std::memcpy(&tmp, data(bytes) + i, sizeof(tmp));
+        word ^= tmp;
+      }
+      word ^= word >> 32u;
+      word ^= word >> 16u;
+      word ^= word >> 8u;
+      _exor ^= static_cast<uint8_t>(word);
+    }
+    for (; i < size(bytes); ++i) update(bytes[i]);
+    return *this;
+  }
+
+  /// Get value
+  ///
+  /// \return XOR
+  constexpr uint8_t value() const { return _exor; }
+
+private:
+  uint8_t _exor{};
+};
+
+/// CRC8
+///
+/// \param  bytes Bytes
+/// \param  init  Initial value
+/// \return CRC8
+constexpr uint8_t crc8(std::span<uint8_t const> bytes, uint8_t init = 0u) {
+  return Crc8{init}.update(bytes).value();
+}
+
+/// XOR
+///
+/// \param  bytes Bytes
+/// \return XOR
+constexpr uint8_t exor(std::span<uint8_t const> bytes) {
+  return Exor{}.update(bytes).value();
+}
+
+/// Erased
+///
+/// \details Checks whether all bytes are 0xFF, 8 bytes at a time.
+///
+/// \param  bytes Bytes
+/// \retval true  All bytes are 0xFF
+/// \retval false At least one byte isn't 0xFF
+constexpr bool erased(std::span<uint8_t const> bytes) {
+  auto i{0uz};
+  if !consteval {
+    for (; i + sizeof(uint64_t) <= size(bytes); i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data(bytes) + i, sizeof(word));
+      if (~word) return false;
+    }
+  }
+  for (; i < size(bytes); ++i)
+    if (bytes[i] != 0xFFu) return false;
+  return true;
+}
+
+} // namespace ulf::decup_ein
@@ -0,0 +1,88 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Adaptive response timeouts
+///
+/// \file   ulf/decup_ein/rx/adaptive_timeouts.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "state.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Adaptive response timeouts
+///
+/// \details Tracks the latencies of answered transmissions (1 or 2 pulses) per
+/// decoder family and state. Once enough samples were collected, a percentile
+/// plus margin replaces the DECUP timeout, which always remains the upper
+/// bound. Families are keyed by ZSU decoder ID, ID 0 collects everything before
+/// a decoder ID got acknowledged (e.g. all of ZPP). Unanswered transmissions
+/// are only recorded if they ran with an adapted timeout, as latency of the
+/// top bucket. Silence under the DECUP timeout is a regular answer, but under
+/// an adapted one it might mean the timeout got too short. ZSU decoder ID
+/// probes always use the DECUP timeout, most decoders leave them unanswered so
+/// a too short one would go unnoticed.
+///
+/// The family table is trivially copyable and can be persisted across sessions
+/// by storing \ref families() and restoring it with \ref families(std::span).
+class AdaptiveTimeouts {
+public:
+  /// Number of latency histogram buckets, spaced half an octave apart down to
+  /// 1/181 of the DECUP timeout
+  static constexpr size_t buckets{16uz};
+
+  /// Number of tracked decoder families
+  static constexpr size_t max_families{4uz};
+
+  /// Latency histograms of one decoder family
+  struct Family {
+    bool used{};          ///< Entry in use
+    uint8_t decoder_id{}; ///< Decoder ID
+    std::array<std::array<uint8_t, buckets>,
+               std::to_underlying(State::Count)>
+      histograms{}; ///< Latency histograms per state
+  };
+  static_assert(std::is_trivially_copyable_v<Family>);
+
+  /// Ctor
+  ///
+  /// \param  percentile  Percentile [%], anything above 100 is clamped
+  /// \param  margin      Margin added on top of percentile [%]
+  /// \param  min_samples Minimum number of samples before adapting
+  constexpr explicit AdaptiveTimeouts(uint8_t percentile = 99u,
+                                      uint8_t margin = 50u,
+                                      uint8_t min_samples = 16u)
+    : _percentile{std::min<uint8_t>(percentile, 100u)}, _margin{margin},
+      _min_samples{min_samples} {}
+
+  uint32_t timeout(uint8_t decoder_id, State state, uint32_t max) const;
+  void
+  record(uint8_t decoder_id, State state, uint32_t max, uint32_t latency);
+  std::span<Family const> families() const;
+  void families(std::span<Family const> families);
+  void clear();
+
+  /// Clock [us]
+  uint32_t (*clock)(){};
+
+private:
+  size_t find(uint8_t decoder_id) const;
+
+  std::array<Family, max_families> _families{};
+  size_t _evict{};
+  uint8_t _percentile;
+  uint8_t _margin;
+  uint8_t _min_samples;
+};
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,272 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive asynchronous base
+///
+/// \file   ulf/decup_ein/rx/async_base.hpp
+/// \author Vincent Hamp
+/// \date   24/10/2024
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <decup/decup.hpp>
+#include <optional>
+#include <span>
+#include <string_view>
+#include "adaptive_timeouts.hpp"
+#include "config.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
+#include "state.hpp"
+#include "trace.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx AsyncBase class
+///
+/// \details Pass data into the \ref receive(uint8_t) method to use. Doing this
+/// may result in a call to transmitAsync, which only starts a transmission.
+/// Once the decoder answered (or timed out) the backend has to call
+/// \ref complete with the received pulse count. Until then no further data
+/// must be received. Whole transfers (e.g. USB bulk packets) can be passed at
+/// once into the \ref receive(std::span<uint8_t const>, std::span<uint8_t>)
+/// overload, which copies block and packet payloads in bulk and stops at
+/// pending transmissions. ZSU blocks are double-buffered, the next block can
+/// be received while the current one is still in flight.
+///
+/// Protocols which aren't enabled in \ref config.hpp are ignored and the
+/// packet buffers shrink to what the enabled ones need.
+///
+/// Calling reset() resets the internal state
+class AsyncBase {
+public:
+  /// Result of bulk receive
+  struct Result {
+    size_t in{};  ///< Number of bytes consumed
+    size_t out{}; ///< Number of responses written
+  };
+
+  /// Opt-in features
+  using Options = rx::Options;
+
+  /// CV
+  struct Cv {
+    uint16_t address{}; ///< Address (CV number - 1)
+    uint8_t value{};    ///< Value
+  };
+
+  /// ZSU session descriptor
+  ///
+  /// Computed once the decoder ID got acknowledged, the block count follows
+  /// with the block count byte. Stays available after the last block got
+  /// acknowledged until the next decoder ID is acknowledged or \ref reset is
+  /// called.
+  struct SessionInfo {
+    uint8_t decoder_id{};       ///< Acknowledged decoder ID
+    uint8_t stop_bits{};        ///< Stop bit count
+    uint16_t block_size{};      ///< Block size without counter and XOR
+    uint16_t bootloader_size{}; ///< Bootloader size
+    uint16_t block_count{};     ///< Total number of blocks
+    uint16_t block_index{};     ///< Index of first unacknowledged block
+    uint32_t byte_count{};      ///< Total number of payload bytes
+  };
+
+  /// ZSU checkpoint
+  struct Checkpoint {
+    uint8_t decoder_id{};   ///< Acknowledged decoder ID
+    uint16_t block{};       ///< Index of first unacknowledged block
+    uint16_t block_count{}; ///< Number of remaining blocks
+  };
+
+  /// Dtor
+  virtual constexpr ~AsyncBase() = default;
+
+  std::optional<uint8_t> receive(uint8_t byte);
+  Result receive(std::span<uint8_t const> bytes, std::span<uint8_t> responses);
+  std::optional<uint8_t> complete(uint8_t pulse_count);
+  std::optional<uint8_t> pendingResponse();
+  std::optional<uint8_t> reset();
+  bool pending() const;
+  void options(Options options);
+  Options options() const;
+  State state() const;
+  void metrics(Metrics* metrics);
+  void timeouts(AdaptiveTimeouts* timeouts);
+  void trace(Trace* trace);
+  std::optional<uint8_t> readCvs(std::span<uint16_t const> cvs,
+                                 std::span<uint8_t> values,
+                                 std::span<uint8_t> errors);
+  std::optional<uint8_t>
+  readCvs(uint16_t first, std::span<uint8_t> values, std::span<uint8_t> errors);
+  std::optional<SessionInfo> sessionInfo() const;
+  std::optional<Checkpoint> checkpoint() const;
+  size_t skipped() const;
+  std::optional<uint8_t> restore(Checkpoint const& checkpoint);
+  std::optional<uint8_t> writeCvs(std::span<Cv const> cvs,
+                                  uint8_t max_retries = 3u);
+
+protected:
+  State transmitState() const;
+
+private:
+  /// Callback invoked with pulse count on completion, may override response
+  using Done = void (*)(AsyncBase&, uint8_t);
+
+  /// Clock [us]
+  using Clock = uint32_t (*)();
+
+  /// Progress of CvSet sequence
+  enum class CvSetPhase : uint8_t { Start, Write, End, Done };
+
+  /// Start transmitting bytes
+  ///
+  /// Bytes stay valid until \ref complete or \ref reset is called.
+  ///
+  /// \param bytes    Bytes
+  /// \param timeout  Response timeout [us]
+  virtual void transmitAsync(std::span<uint8_t const> bytes,
+                             uint32_t timeout) = 0;
+
+  /// Config
+  ///
+  /// (Re-)Configure UART transmit parameters.
+  ///
+  /// \param  stop_bits Stop bit count
+  virtual void config(uint8_t stop_bits) = 0;
+
+  /// Config UART
+  ///
+  /// (Re-)Configure UART transmit parameters including baud rate. Backends
+  /// which support Options::high_speed must override this, the default only
+  /// forwards stop bits to \ref config and can't switch the baud rate. The
+  /// DECUP default must always be applied.
+  ///
+  /// \param  stop_bits Stop bit count
+  /// \param  baud_rate Baud rate (or 0 for DECUP default)
+  /// \retval true      Baud rate applied
+  /// \retval false     Baud rate unsupported, nothing changed
+  virtual bool configUart(uint8_t stop_bits, uint32_t baud_rate);
+
+  /// Reset backend
+  ///
+  /// Called by \ref reset before the internal state gets reset. Backends which
+  /// track transmissions of their own must override this to drop them.
+  virtual void resetBackend();
+
+  std::optional<uint8_t> dispatch(uint8_t byte);
+  std::optional<uint8_t> restart();
+  void publishSession(SessionInfo const& session);
+  void configure(uint8_t stop_bits);
+  bool configure(uint8_t stop_bits, uint32_t baud_rate);
+
+  std::optional<uint8_t> start(State state,
+                               std::span<uint8_t const> bytes,
+                               uint32_t timeout,
+                               Done done = nullptr);
+  std::optional<uint8_t>
+  start(State state, uint8_t byte, uint32_t timeout, Done done = nullptr);
+
+  std::optional<uint8_t> reject(State state, Done done = nullptr);
+
+  std::optional<uint8_t> entry(uint8_t byte);
+  std::optional<uint8_t> preamble(uint8_t byte);
+
+  std::optional<uint8_t> zpp(uint8_t byte);
+  std::optional<uint8_t> zppReadCv(uint8_t byte);
+  std::optional<uint8_t> zppWriteCv(uint8_t byte);
+  std::optional<uint8_t> zppFlashErase(uint8_t byte);
+  std::optional<uint8_t> zppFlashWrite(uint8_t byte);
+  std::optional<uint8_t> zppFlashPacket(std::span<uint8_t const> packet);
+  std::optional<uint8_t> zppDecoderId(uint8_t byte);
+  std::optional<uint8_t> zppCrcXorQuery(uint8_t byte);
+  std::optional<uint8_t> zppBits(State state,
+                                 std::span<uint8_t const> packet,
+                                 uint32_t timeout);
+  static void zppBit(AsyncBase& self, uint8_t pulse_count);
+  static void zppFlashErased(AsyncBase& self, uint8_t pulse_count);
+  void zppHighSpeed();
+  void zppHighSpeedNext(bool valid);
+  std::optional<uint8_t> zppReadCvs(std::span<uint16_t const> cvs,
+                                    uint16_t first,
+                                    std::span<uint8_t> values,
+                                    std::span<uint8_t> errors);
+  std::optional<uint8_t> zppReadCvs();
+  void zppReadCvsNext(bool valid);
+  std::optional<uint8_t> zppWriteCvs();
+  std::optional<uint8_t> zppCvSetPacket(decup::CvSetSubcommand subcommand,
+                                        uint8_t data0,
+                                        uint8_t data1);
+  static void zppCvSetAck(AsyncBase& self, uint8_t pulse_count);
+  bool zppReady();
+  std::optional<uint8_t> zppCvSet(uint8_t byte);
+  std::optional<uint8_t> zppCvSetManipulate(uint8_t byte);
+  std::optional<uint8_t> zppCvSetFeatureRequest(uint8_t byte);
+
+  std::optional<uint8_t> zsuDecoderId(uint8_t byte);
+  std::optional<uint8_t> zsuBlockCount(uint8_t byte);
+  std::optional<uint8_t> zsuSecurityByte1(uint8_t byte);
+  std::optional<uint8_t> zsuSecurityByte2(uint8_t byte);
+  std::optional<uint8_t> zsuBlocks(uint8_t byte);
+  std::optional<uint8_t> zsuBlock(std::span<uint8_t const> block);
+
+  size_t payloadSize() const;
+  std::span<uint8_t const>
+  contiguousPacket(std::span<uint8_t const> bytes) const;
+  std::optional<uint8_t> forward(std::span<uint8_t const> packet);
+
+  Clock clock() const;
+  void recordReceive(State state, size_t count);
+  void recordLocal(State state, uint8_t pulse_count);
+  void recordStart(uint32_t timeout);
+  void recordComplete(uint8_t pulse_count);
+
+  Packet _packet{};
+  Packet _next{};
+  std::span<uint8_t const> _deferred{};
+  std::span<uint16_t const> _cvs{};
+  std::span<uint8_t> _values{};
+  std::span<uint8_t> _errors{};
+  std::span<Cv const> _cv_writes{};
+  std::optional<uint8_t> (AsyncBase::*_state)(uint8_t){&AsyncBase::entry};
+  Done _done{};
+  std::optional<uint8_t> _response{};
+  std::optional<uint8_t> _queued{};
+  Options _options{};
+  Metrics* _metrics{};
+  AdaptiveTimeouts* _timeouts{};
+  Trace* _trace{};
+  uint32_t _transmit_time{};
+  uint32_t _transmit_timeout{};
+  uint32_t _bit_timeout{};
+  uint32_t _deferred_timeout{};
+  uint32_t _deferred_nominal{};
+  uint32_t _baud_rate{};
+  size_t _cv_index{};
+  size_t _skipped{};
+  size_t _unrecorded{};
+  size_t _discard{};
+  State _transmit_state{};
+  SessionInfo _session{};
+  /// ZSU session published to other tasks (decoder ID, block count and block
+  /// index packed into a single word so they never tear)
+  std::atomic<uint32_t> _shared_session{};
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+  uint8_t _byte{};
+  uint8_t _bits{};
+  uint8_t _bit_count{};
+  uint16_t _first_cv{};
+  uint16_t _page{};
+  uint8_t _retries{};
+  uint8_t _max_retries{};
+  CvSetPhase _cvset_phase{};
+  bool _pending{};
+  bool _transmitting{};
+  bool _negotiating{};
+  bool _adapted{};
+  bool _erased{};
+};
+
+} // namespace ulf::decup_ein::rx
@@ -8,27 +8,24 @@
 /// \author Vincent Hamp
 /// \date   24/10/2024
 
-#include <cstdint>
-#include <decup/decup.hpp>
-#include <optional>
-#include <string_view>
+#pragma once
+
+#include "async_base.hpp"
 
 namespace ulf::decup_ein::rx {
 
 /// Rx Base class
 ///
-/// \details Pass data into the \ref receive(uint8_t) method to use. Doing this
-/// may result in a call to transmit
+/// \details Synchronous adapter over AsyncBase. Pass data into the
+/// \ref receive(uint8_t) method to use. Doing this may result in a call to
+/// transmit, which blocks until the decoder answered (or timed out).
 ///
 /// Calling reset() resets the internal state
-class Base {
+class Base : public AsyncBase {
 public:
   /// Dtor
   virtual constexpr ~Base() = default;
 
-  std::optional<uint8_t> receive(uint8_t byte);
-  std::optional<uint8_t> reset();
-
 private:
   /// Transmit bytes
   ///
@@ -38,37 +35,7 @@ private:
   virtual uint8_t transmit(std::span<uint8_t const> bytes,
                            uint32_t timeout) = 0;
 
-  /// Config
-  ///
-  /// (Re-)Configure UART transmit parameters.
-  ///
-  /// \param  stop_bits Stop bit count
-  virtual void config(uint8_t stop_bits) = 0;
-
-  std::optional<uint8_t> entry(uint8_t byte);
-  std::optional<uint8_t> preamble(uint8_t byte);
-
-  std::optional<uint8_t> zpp(uint8_t byte);
-  std::optional<uint8_t> zppReadCv(uint8_t byte);
-  std::optional<uint8_t> zppWriteCv(uint8_t byte);
-  std::optional<uint8_t> zppFlashErase(uint8_t byte);
-  std::optional<uint8_t> zppFlashWrite(uint8_t byte);
-  std::optional<uint8_t> zppDecoderId(uint8_t byte);
-  std::optional<uint8_t> zppCrcXorQuery(uint8_t byte);
-  std::optional<uint8_t> zppCvSet(uint8_t byte);
-  std::optional<uint8_t> zppCvSetManipulate(uint8_t byte);
-  std::optional<uint8_t> zppCvSetFeatureRequest(uint8_t byte);
-
-  std::optional<uint8_t> zsuDecoderId(uint8_t byte);
-  std::optional<uint8_t> zsuBlockCount(uint8_t byte);
-  std::optional<uint8_t> zsuSecurityByte1(uint8_t byte);
-  std::optional<uint8_t> zsuSecurityByte2(uint8_t byte);
-  std::optional<uint8_t> zsuBlocks(uint8_t byte);
-
-  decup::Packet _packet{};
-  std::optional<uint8_t> (Base::*_state)(uint8_t){&Base::entry};
-  size_t _block_count{};
-  uint8_t _decoder_id{};
+  void transmitAsync(std::span<uint8_t const> bytes, uint32_t timeout) final;
 };
 
 } // namespace ulf::decup_ein::rx
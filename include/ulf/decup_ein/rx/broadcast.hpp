@@ -0,0 +1,88 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive broadcast
+///
+/// \file   ulf/decup_ein/rx/broadcast.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include "async_base.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx Broadcast class
+///
+/// \details Fans a single host stream out to multiple identical decoders, each
+/// connected to its own UART channel. Every transmission gets started on all
+/// channels which haven't failed so far. Once all of them called
+/// \ref complete(size_t, uint8_t), the pulse counts get aggregated into a
+/// single response, which is the majority of the channels that answered at all.
+/// Channels which disagree with the majority are marked as failed and are
+/// skipped from then on.
+///
+/// ZSU blocks and ZPP flash packets are the exception, the host repeats those
+/// on a Nak. Channels which answer with a single pulse where the majority
+/// answered with a double pulse get repeated up to max_retries times. Channels
+/// which still disagree with a double pulse majority or don't answer at all
+/// fail. Channels answering a single pulse majority with a double pulse
+/// accepted a packet the others rejected. They skip the host's repeat of that
+/// packet and fail on anything else, since they are out of sync with the
+/// others. Everywhere else pulse counts carry data (e.g. bits of a CV read),
+/// so there is nothing to repeat or skip.
+class Broadcast : public AsyncBase {
+public:
+  /// Maximum number of channels (width of failure bitmap)
+  static constexpr size_t max_channels{64uz};
+
+  explicit Broadcast(size_t channels, uint8_t max_retries = 3u);
+
+  /// Dtor
+  virtual constexpr ~Broadcast() = default;
+
+  std::optional<uint8_t> complete(size_t channel, uint8_t pulse_count);
+  void channels(size_t channels);
+  size_t channels() const;
+  uint64_t failed() const;
+  size_t retries(size_t channel) const;
+
+private:
+  /// Start transmitting bytes on a single channel
+  ///
+  /// Bytes stay valid until \ref complete(size_t, uint8_t) is called for that
+  /// channel.
+  ///
+  /// \param channel  Channel
+  /// \param bytes    Bytes
+  /// \param timeout  Response timeout [us]
+  virtual void transmitChannel(size_t channel,
+                               std::span<uint8_t const> bytes,
+                               uint32_t timeout) = 0;
+
+  void transmitAsync(std::span<uint8_t const> bytes, uint32_t timeout) final;
+  void resetBackend() final;
+
+  std::optional<uint8_t> aggregate();
+  bool repeatable() const;
+  uint64_t active() const;
+  uint8_t majority() const;
+
+  std::array<uint8_t, max_packet_size> _accepted{};
+  std::array<uint8_t, max_channels> _pulse_counts{};
+  std::array<uint8_t, max_channels> _repeats{};
+  std::array<size_t, max_channels> _retries{};
+  std::span<uint8_t const> _bytes{};
+  uint64_t _outstanding{};
+  uint64_t _failed{};
+  uint64_t _ahead{};
+  size_t _accepted_size{};
+  size_t _channels{};
+  uint32_t _timeout{};
+  uint8_t _max_retries{};
+};
+
+} // namespace ulf::decup_ein::rx
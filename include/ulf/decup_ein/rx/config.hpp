@@ -0,0 +1,89 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive compile-time configuration
+///
+/// The footprint gets selected by global macros rather than by a config
+/// template parameter (e.g. BasicBase<Config>). The state machines are
+/// compiled once into a static library, a template parameter would move all
+/// of them into headers and instantiate them once per config. Firmware only
+/// ever needs a single footprint, so all translation units of a build have
+/// to agree on these macros, which the CMake options take care of.
+///
+/// \file   ulf/decup_ein/rx/config.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <decup/decup.hpp>
+#include <type_traits>
+
+/// Receive ZPP (CV and flash access)
+#if !defined(ULF_DECUP_EIN_ZPP)
+#  define ULF_DECUP_EIN_ZPP 1
+#endif
+
+/// Receive ZSU (firmware updates)
+#if !defined(ULF_DECUP_EIN_ZSU)
+#  define ULF_DECUP_EIN_ZSU 1
+#endif
+
+/// Receive ZPP CvSet commands and run CvSet sequences
+#if !defined(ULF_DECUP_EIN_CVSET)
+#  define ULF_DECUP_EIN_CVSET ULF_DECUP_EIN_ZPP
+#endif
+
+/// Width of metric counters (16 or 32)
+#if !defined(ULF_DECUP_EIN_COUNTER_BITS)
+#  define ULF_DECUP_EIN_COUNTER_BITS 32
+#endif
+
+static_assert(ULF_DECUP_EIN_ZPP || ULF_DECUP_EIN_ZSU,
+              "At least one of ZPP or ZSU must be enabled");
+static_assert(!ULF_DECUP_EIN_CVSET || ULF_DECUP_EIN_ZPP,
+              "CvSet requires ZPP");
+static_assert(ULF_DECUP_EIN_COUNTER_BITS == 16 ||
+                ULF_DECUP_EIN_COUNTER_BITS == 32,
+              "Counters must be either 16 or 32 bit wide");
+
+namespace ulf::decup_ein::rx {
+
+namespace detail {
+
+template<typename T, size_t N>
+struct Rebind;
+
+template<template<typename, size_t> typename V,
+         typename T,
+         size_t M,
+         size_t N>
+struct Rebind<V<T, M>, N> {
+  using type = V<T, N>;
+};
+
+} // namespace detail
+
+inline constexpr bool zpp_enabled{ULF_DECUP_EIN_ZPP};
+inline constexpr bool zsu_enabled{ULF_DECUP_EIN_ZSU};
+inline constexpr bool cvset_enabled{ULF_DECUP_EIN_CVSET};
+
+/// Largest ZSU block including counter and XOR trailer
+inline constexpr size_t max_zsu_block_size{64uz + 2uz};
+
+/// Packet capacity, ZPP flash packets are the largest
+inline constexpr size_t max_packet_size{
+  zpp_enabled ? DECUP_MAX_PACKET_SIZE : max_zsu_block_size};
+
+/// Packet sized to the enabled protocols
+using Packet = detail::Rebind<decup::Packet, max_packet_size>::type;
+
+/// Metric counter
+using Counter = std::conditional_t<ULF_DECUP_EIN_COUNTER_BITS == 16,
+                                   uint16_t,
+                                   uint32_t>;
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,423 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive static dispatch engine
+///
+/// \file   ulf/decup_ein/rx/engine.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <decup/decup.hpp>
+#include <optional>
+#include <span>
+#include "../ack.hpp"
+#include "../checksum.hpp"
+#include "../nak.hpp"
+#include "../pulse_count2response.hpp"
+#include "config.hpp"
+#include "options.hpp"
+#include "protocol.hpp"
+#include "state.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx Engine class
+///
+/// \details Static dispatch variant of \ref Base for byte-wise drivers (e.g. a
+/// UART interrupt). Instead of virtual calls, Derived has to provide
+///
+/// \code
+/// uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout);
+/// void config(uint8_t stop_bits);
+/// \endcode
+///
+/// which get called directly and can be inlined into \ref receive. Derived
+/// may additionally provide
+///
+/// \code
+/// bool configUart(uint8_t stop_bits, uint32_t baud_rate);
+/// \endcode
+///
+/// which then replaces config and is required for Options::high_speed. It
+/// returns whether the baud rate got applied, see AsyncBase::configUart. They
+/// may be private if Derived befriends Engine. The state is a plain \ref State
+/// which gets switched on for every byte. Packet rules are shared with
+/// \ref AsyncBase through rx/protocol.hpp, all options but
+/// Options::preamble_burst are supported. Bulk receive, metrics, traces and CV
+/// sequences are only supported by \ref AsyncBase.
+///
+/// \tparam Derived   Derived class
+/// \tparam BlockSize ZSU block size fixed at compile time (32 or 64), decoders
+///                   with other block sizes are ignored. Without ZPP the
+///                   packet buffer shrinks to a single block. With 0 the block
+///                   size is looked up once the decoder ID got acknowledged.
+template<typename Derived, size_t BlockSize = 0uz>
+class Engine {
+  static_assert(!BlockSize || BlockSize == 32uz || BlockSize == 64uz,
+                "ZSU block size must be either 32 or 64");
+
+public:
+  /// Receive single byte (from e.g. USB)
+  ///
+  /// \param  byte          Byte
+  /// \retval std::optional No result (yet)
+  /// \retval uint8_t       Pulse count
+  constexpr std::optional<uint8_t> receive(uint8_t byte) {
+    // By far the most bytes are block and flash payloads
+    if (_state == State::ZsuBlocks) [[likely]]
+      return zsuBlocks(byte);
+    else if (_state == State::ZppFlashWrite) [[likely]]
+      return zppFlashWrite(byte);
+    switch (_state) {
+      case State::Entry:
+        // Ignore entry string which might occur multiple times...
+        if (detail::entry(byte)) return std::nullopt;
+        _state = State::Preamble;
+        return preamble(byte);
+      case State::Preamble: return preamble(byte);
+      case State::Zpp: return zpp(byte);
+      case State::ZppReadCv: return zppReadCv(byte);
+      case State::ZppWriteCv: return zppWriteCv(byte);
+      case State::ZppFlashErase: return zppFlashErase(byte);
+      case State::ZppDecoderId: [[fallthrough]];
+      case State::ZppCrcXorQuery: return zppQuery(byte);
+      case State::ZppCvSet: return zppCvSet(byte);
+      case State::ZppCvSetManipulate: return zppCvSetManipulate(byte);
+      case State::ZppCvSetFeatureRequest: return zppCvSetFeatureRequest(byte);
+      case State::ZsuDecoderId: return zsuDecoderId(byte);
+      case State::ZsuBlockCount: return zsuBlockCount(byte);
+      case State::ZsuSecurityByte1: [[fallthrough]];
+      case State::ZsuSecurityByte2: return zsuSecurityByte(byte);
+      default: return std::nullopt;
+    }
+  }
+
+  /// Reset
+  ///
+  /// Reset internal state to initial and reconfigure with 1 stop bit.
+  ///
+  /// \return std::nullopt
+  constexpr std::optional<uint8_t> reset() {
+    _size = 0u;
+    _state = State::Entry;
+    _block_count = _block_index = 0u;
+    _decoder_id = 0u;
+    _block_size = 0u;
+    _baud_rate = 0u;
+    _erased = false;
+    configure(1u);
+    return std::nullopt;
+  }
+
+  /// Set options
+  ///
+  /// An Options::high_speed which can't be requested gets disabled.
+  ///
+  /// \param  options Options
+  constexpr void options(Options options) {
+    if (!detail::high_speed_valid(options.high_speed)) options.high_speed = 0u;
+    _options = options;
+  }
+
+  /// Get options
+  ///
+  /// \return Options
+  constexpr Options options() const { return _options; }
+
+  /// Get current state
+  ///
+  /// \return State
+  constexpr State state() const { return _state; }
+
+  /// Get number of skipped ZPP flash packets
+  ///
+  /// Counts packets acknowledged locally due to Options::skip_erased since the
+  /// last successful flash erase.
+  ///
+  /// \return Number of skipped packets
+  constexpr size_t skipped() const { return _skipped; }
+
+private:
+  constexpr Derived& impl() { return static_cast<Derived&>(*this); }
+
+  constexpr void configure(uint8_t stop_bits) {
+    if constexpr (requires { impl().configUart(stop_bits, _baud_rate); })
+      impl().configUart(stop_bits, _baud_rate);
+    else impl().config(stop_bits);
+  }
+
+  constexpr uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout) {
+    return impl().transmit(bytes, timeout);
+  }
+
+  constexpr uint8_t transmit(uint8_t byte, uint32_t timeout) {
+    return transmit({&byte, sizeof(byte)}, timeout);
+  }
+
+  constexpr std::optional<uint8_t> start(std::span<uint8_t const> bytes,
+                                         uint32_t timeout) {
+    return pulse_count2response(transmit(bytes, timeout));
+  }
+
+  constexpr std::optional<uint8_t> start(uint32_t timeout) {
+    return start(packet(), timeout);
+  }
+
+  constexpr std::optional<uint8_t> start(uint8_t byte, uint32_t timeout) {
+    return pulse_count2response(transmit(byte, timeout));
+  }
+
+  constexpr std::span<uint8_t const> packet() const {
+    return {data(_packet), _size};
+  }
+
+  constexpr void push(uint8_t byte) {
+    if (_size < size(_packet)) _packet[_size++] = byte;
+  }
+
+  constexpr size_t blockSize() const {
+    if constexpr (BlockSize) return BlockSize;
+    else return _block_size;
+  }
+
+  constexpr std::optional<uint8_t> preamble(uint8_t byte) {
+    // Still Preamble?
+    if (detail::preamble(byte))
+      return start(byte, decup::Timeouts::zpp_preamble);
+    // Continue with ZPP
+    else if (byte < 0x80u) {
+      if constexpr (zpp_enabled) {
+        configure(2u);
+        _state = State::Zpp;
+        return zpp(byte);
+      }
+    }
+    // Continue with ZSU
+    else {
+      if constexpr (zsu_enabled) {
+        _state = State::ZsuDecoderId;
+        return zsuDecoderId(byte);
+      }
+    }
+    return std::nullopt;
+  }
+
+  constexpr std::optional<uint8_t> zpp(uint8_t byte) {
+    _size = 0u;
+    _state = detail::zpp_command2state(byte);
+    if (_state == State::Zpp) return std::nullopt;
+    return receive(byte);
+  }
+
+  // Transmit packet and the dummy bytes following it locally, assemble the
+  // answered byte (MSB first, a double pulse is a 1). Hosts get a Nak instead
+  // if a bit is missing.
+  constexpr std::optional<uint8_t> zppBits(std::span<uint8_t const> bytes,
+                                           uint32_t timeout) {
+    _state = State::Zpp;
+    uint8_t bits{};
+    for (auto i{0uz}; i < CHAR_BIT; ++i) {
+      auto const pulse_count{i ? transmit(0xFFu, timeout)
+                               : transmit(bytes, timeout)};
+      if (pulse_count != 1u && pulse_count != 2u) return std::nullopt;
+      bits = static_cast<uint8_t>(bits << 1u | (pulse_count == 2u));
+    }
+    return bits;
+  }
+
+  constexpr std::optional<uint8_t> zppReadCv(uint8_t byte) {
+    push(byte);
+    if (_size < detail::zpp_cv_read_size) return std::nullopt;
+    else if (_size == detail::zpp_cv_read_size)
+      return _options.assemble_bits
+               ? zppBits(packet(), decup::Timeouts::zpp_cv_read).value_or(nak)
+               : start(decup::Timeouts::zpp_cv_read);
+    if (_size == detail::zpp_cv_read_size + detail::zpp_dummy_count)
+      _state = State::Zpp;
+    return start(byte, decup::Timeouts::zpp_cv_read);
+  }
+
+  constexpr std::optional<uint8_t> zppWriteCv(uint8_t byte) {
+    push(byte);
+    if (_size == detail::zpp_cv_write_size(_packet[0uz])) {
+      _state = State::Zpp;
+      return start(decup::Timeouts::zpp_cv_write);
+    }
+    return std::nullopt;
+  }
+
+  constexpr std::optional<uint8_t> zppFlashErase(uint8_t byte) {
+    push(byte);
+    if (_size == detail::zpp_flash_erase_size &&
+        detail::zpp_flash_erase_valid(packet())) {
+      _state = State::Zpp;
+      auto const pulse_count{
+        transmit(packet(), decup::Timeouts::zpp_flash_erase)};
+      if (pulse_count == 2u) {
+        _erased = true;
+        _skipped = 0uz;
+        if (_options.high_speed && !_baud_rate) zppHighSpeed();
+      }
+      return pulse_count2response(pulse_count);
+    } else if (_size >= detail::zpp_flash_erase_size)
+      _state = State::Zpp; // Incorrect security bytes
+    return std::nullopt;
+  }
+
+  constexpr std::optional<uint8_t> zppFlashWrite(uint8_t byte) {
+    _packet[_size++] = byte;
+    if (_size < DECUP_MAX_PACKET_SIZE) return std::nullopt;
+    _state = State::Zpp;
+    if (_options.validate && !detail::zpp_flash_packet_valid(packet()))
+      return nak;
+    // Erased flash already reads 0xFF
+    if (_options.skip_erased && _erased &&
+        erased(detail::zpp_flash_payload(packet()))) {
+      ++_skipped;
+      return ack;
+    }
+    return start(decup::Timeouts::zpp_flash_write);
+  }
+
+  // Ask decoder for Options::high_speed if Derived can switch to it and switch
+  // if the decoder echoed the rate
+  constexpr void zppHighSpeed() {
+    if constexpr (requires { impl().configUart(uint8_t{}, uint32_t{}); }) {
+      if (!impl().configUart(2u, _options.high_speed)) return;
+      configure(2u);
+      auto const request{detail::zpp_high_speed_request(_options.high_speed)};
+      if (zppBits(request, decup::Timeouts::zpp_cvset) == request[3uz]) {
+        _baud_rate = request[3uz] * detail::baud_rate_unit;
+        configure(2u);
+      }
+    }
+  }
+
+  // Decoder ID or CRC/XOR query, command followed by 7 dummy bytes
+  constexpr std::optional<uint8_t> zppQuery(uint8_t byte) {
+    auto const timeout{_state == State::ZppDecoderId
+                         ? decup::Timeouts::zpp_decoder_id
+                         : decup::Timeouts::zpp_crc_or_xor};
+    push(byte);
+    if (_options.assemble_bits)
+      return zppBits(packet(), timeout).value_or(nak);
+    if (_size == 1u + detail::zpp_dummy_count) _state = State::Zpp;
+    return start(byte, timeout);
+  }
+
+  constexpr std::optional<uint8_t> zppCvSet(uint8_t byte) {
+    // Check if command or subcommand
+    if (_size == 1u) {
+      _state = detail::zpp_cvset_subcommand2state(byte);
+      if (_state != State::ZppCvSet) return receive(byte);
+    }
+    push(byte);
+    return std::nullopt;
+  }
+
+  constexpr std::optional<uint8_t> zppCvSetManipulate(uint8_t byte) {
+    push(byte);
+    if (_size < detail::zpp_cvset_size) return std::nullopt;
+    _state = State::Zpp;
+    if (_options.validate && !detail::zpp_cvset_packet_valid(packet()))
+      return nak;
+    return start(decup::Timeouts::zpp_cvset);
+  }
+
+  constexpr std::optional<uint8_t> zppCvSetFeatureRequest(uint8_t byte) {
+    push(byte);
+    if (_size < detail::zpp_cvset_size) return std::nullopt;
+    else if (_size == detail::zpp_cvset_size) {
+      // Corrupt packet, skip dummy bytes
+      if (_options.validate && !detail::zpp_cvset_packet_valid(packet())) {
+        _state = State::Zpp;
+        return nak;
+      }
+      return _options.assemble_bits
+               ? zppBits(packet(), decup::Timeouts::zpp_cvset).value_or(nak)
+               : start(decup::Timeouts::zpp_cvset);
+    }
+    // Dummy Bytes
+    if (_size == detail::zpp_cvset_size + detail::zpp_dummy_count)
+      _state = State::Zpp;
+    return start(byte, decup::Timeouts::zpp_cvset);
+  }
+
+  constexpr std::optional<uint8_t> zsuDecoderId(uint8_t byte) {
+    // Leave decoders with other block sizes to other bridges
+    if constexpr (BlockSize)
+      if (decup::decoder_id2block_size(byte) != BlockSize) return std::nullopt;
+    auto const pulse_count{transmit(byte, decup::Timeouts::zsu_decoder_id)};
+    if (pulse_count == 2u) {
+      _state = State::ZsuBlockCount;
+      _decoder_id = byte;
+      if constexpr (!BlockSize)
+        _block_size =
+          static_cast<uint16_t>(decup::decoder_id2block_size(byte));
+    }
+    return pulse_count2response(pulse_count);
+  }
+
+  constexpr std::optional<uint8_t> zsuBlockCount(uint8_t byte) {
+    auto const pulse_count{transmit(byte, decup::Timeouts::zsu_page_count)};
+    if (pulse_count == 1u) {
+      _state = State::ZsuSecurityByte1;
+      auto const bootloader_size{
+        decup::decoder_id2bootloader_size(_decoder_id)};
+      configure(detail::zsu_stop_bits(bootloader_size));
+      _block_count =
+        detail::zsu_block_count(byte, bootloader_size, blockSize());
+      _block_index = 0u;
+    }
+    return pulse_count2response(pulse_count);
+  }
+
+  constexpr std::optional<uint8_t> zsuSecurityByte(uint8_t byte) {
+    auto const first{_state == State::ZsuSecurityByte1};
+    if (byte != (first ? 0x55u : 0xAAu)) return reset();
+    auto const pulse_count{
+      transmit(byte, decup::Timeouts::zsu_security_bytes)};
+    if (pulse_count == 1u)
+      _state = first ? State::ZsuSecurityByte2 : State::ZsuBlocks;
+    return pulse_count2response(pulse_count);
+  }
+
+  constexpr std::optional<uint8_t> zsuBlocks(uint8_t byte) {
+    _packet[_size++] = byte;
+    // Not enough bytes
+    if (_size < blockSize() + detail::zsu_block_overhead) return std::nullopt;
+    auto const block{packet()};
+    _size = 0u;
+    if (_options.validate && !detail::zsu_block_valid(block)) return nak;
+    auto const pulse_count{transmit(block, decup::Timeouts::zsu_blocks)};
+    if (pulse_count == 2u) {
+      ++_block_index;
+      // Last packet transmitted successfully
+      if (!--_block_count) reset();
+    }
+    return pulse_count2response(pulse_count);
+  }
+
+  std::array<uint8_t,
+             BlockSize && !zpp_enabled ? BlockSize + detail::zsu_block_overhead
+                                       : max_packet_size>
+    _packet{};
+  Options _options{};
+  size_t _skipped{};
+  uint32_t _baud_rate{};
+  uint16_t _size{};
+  State _state{};
+  uint8_t _decoder_id{};
+  uint16_t _block_size{};
+  uint16_t _block_count{};
+  uint16_t _block_index{};
+  bool _erased{};
+};
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,59 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive metrics
+///
+/// \file   ulf/decup_ein/rx/metrics.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "config.hpp"
+#include "state.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Session metrics
+///
+/// \details Counters get updated by the receiving task only, so they can be
+/// read from any other task or thread without locking. Transmission latencies
+/// are only recorded if a clock is set. Event counters are \ref Counter wide
+/// and wrap around, see ULF_DECUP_EIN_COUNTER_BITS.
+struct Metrics {
+  /// Number of latency histogram buckets
+  static constexpr size_t buckets{8uz};
+
+  /// Counters per state
+  struct Counters {
+    std::atomic<Counter> bytes{};    ///< Received bytes
+    std::atomic<Counter> acks{};     ///< Double pulses
+    std::atomic<Counter> naks{};     ///< Single pulses
+    std::atomic<Counter> timeouts{}; ///< No or invalid pulses
+    std::atomic<uint32_t> time{};    ///< Accumulated transmit time [us]
+
+    /// Transmit latencies in fractions of the timeout, the last bucket also
+    /// contains everything exceeding the timeout
+    std::array<std::atomic<Counter>, buckets> latencies{};
+  };
+
+  /// Counters per state
+  ///
+  /// \param  state State
+  /// \return Counters of state
+  constexpr Counters const& operator[](State state) const {
+    return counters[std::to_underlying(state)];
+  }
+
+  /// Clock [us]
+  uint32_t (*clock)(){};
+
+  std::array<Counters, std::to_underlying(State::Count)> counters{};
+};
+
+} // namespace ulf::decup_ein::rx
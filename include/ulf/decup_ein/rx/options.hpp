@@ -0,0 +1,44 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive options
+///
+/// \file   ulf/decup_ein/rx/options.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <cstdint>
+
+namespace ulf::decup_ein::rx {
+
+/// Opt-in features
+struct Options {
+  /// Validate ZSU block XOR and ZPP flash and CvSet CRC8 trailers, corrupt
+  /// packets get answered with Nak without being transmitted
+  bool validate{};
+
+  /// Transmit runs of preamble bytes received in bulk at once and answer them
+  /// with a single response
+  bool preamble_burst{};
+
+  /// Transmit the dummy bytes of ZPP CV reads, decoder ID, CRC/XOR queries and
+  /// feature requests locally and answer with the assembled byte. Reads with a
+  /// missing bit get answered with Nak, which hosts can't tell apart from an
+  /// assembled 0xFC without reading again.
+  bool assemble_bits{};
+
+  /// Negotiate this baud rate with a CvSet FeatureRequest once the ZPP flash
+  /// got erased and use it for the following flash writes (or 0 to disable).
+  /// Must be a multiple of 9600 up to 255 * 9600, anything else disables it.
+  /// Only backends which can switch their baud rate send the request.
+  uint32_t high_speed{};
+
+  /// Acknowledge ZPP flash packets with all 0xFF payload locally without
+  /// transmitting them, once the flash got erased
+  bool skip_erased{};
+};
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,202 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive protocol rules shared by AsyncBase and Engine
+///
+/// \file   ulf/decup_ein/rx/protocol.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <decup/decup.hpp>
+#include <span>
+#include <string_view>
+#include <utility>
+#include "../checksum.hpp"
+#include "config.hpp"
+#include "state.hpp"
+
+namespace ulf::decup_ein::rx::detail {
+
+/// Size of ZPP CV read packet
+inline constexpr size_t zpp_cv_read_size{3uz};
+
+/// Size of ZPP flash erase packet
+inline constexpr size_t zpp_flash_erase_size{4uz};
+
+/// Size of ZPP CvSet packet
+inline constexpr size_t zpp_cvset_size{5uz};
+
+/// Number of dummy bytes following packets which get answered bit by bit
+inline constexpr size_t zpp_dummy_count{CHAR_BIT - 1uz};
+
+/// Size of block counter and XOR trailer of ZSU blocks
+inline constexpr size_t zsu_block_overhead{2uz};
+
+/// FeatureRequest asking for a faster baud rate, the decoder echoes the rate
+/// (in multiples of 9600) if it supports it and switches after the last bit
+inline constexpr uint8_t feature_baud_rate{0x01u};
+inline constexpr uint32_t baud_rate_unit{9600u};
+
+/// Check if byte is part of the entry string
+///
+/// \param  byte  Byte
+/// \return true  Byte is part of "DECUP_EIN\r"
+/// \return false Byte is not part of "DECUP_EIN\r"
+constexpr bool entry(uint8_t byte) {
+  return std::string_view{"DECUP_EIN\r"}.contains(static_cast<char>(byte));
+}
+
+/// Check if byte is a preamble
+///
+/// \param  byte  Byte
+/// \return true  Byte is a preamble
+/// \return false Byte is not a preamble
+constexpr bool preamble(uint8_t byte) {
+  return byte == std::to_underlying(decup::Command::Preamble0) ||
+         byte == std::to_underlying(decup::Command::Preamble1);
+}
+
+/// Get state following ZPP command
+///
+/// \param  command Command
+/// \return State receiving the command or State::Zpp if unknown or disabled
+constexpr State zpp_command2state(uint8_t command) {
+  switch (command) {
+    case 0x01u: return State::ZppReadCv;
+    case 0x02u: [[fallthrough]];
+    case 0x06u: return State::ZppWriteCv;
+    case 0x03u: return State::ZppFlashErase;
+    case 0x05u: return State::ZppFlashWrite;
+    case 0x04u: return State::ZppDecoderId;
+    case 0x07u: return State::ZppCrcXorQuery;
+    case 0x09u: return cvset_enabled ? State::ZppCvSet : State::Zpp;
+  }
+  return State::Zpp;
+}
+
+/// Get state following ZPP CvSet subcommand
+///
+/// \param  subcommand  Subcommand
+/// \return State receiving the subcommand or State::ZppCvSet if unknown
+constexpr State zpp_cvset_subcommand2state(uint8_t subcommand) {
+  switch (subcommand & 0xFCu) { // Bit 1..0 may be used otherwise
+    case std::to_underlying(decup::CvSetSubcommand::CvWrite): [[fallthrough]];
+    case std::to_underlying(decup::CvSetSubcommand::CvWriteStart):
+      [[fallthrough]];
+    case std::to_underlying(decup::CvSetSubcommand::CvWriteEnd):
+      [[fallthrough]];
+    case std::to_underlying(decup::CvSetSubcommand::ChangePage):
+      return State::ZppCvSetManipulate;
+    case std::to_underlying(decup::CvSetSubcommand::FeatureRequest):
+      return State::ZppCvSetFeatureRequest;
+  }
+  return State::ZppCvSet;
+}
+
+/// Get size of ZPP CV write packet
+///
+/// \param  command Command (0x02 without or 0x06 with CRC8)
+/// \return Size
+constexpr size_t zpp_cv_write_size(uint8_t command) {
+  return command == 0x02u ? 5uz : 6uz;
+}
+
+/// Check security bytes of ZPP flash erase packet
+///
+/// \param  packet  Packet
+/// \return true    Security bytes valid
+/// \return false   Security bytes invalid
+constexpr bool zpp_flash_erase_valid(std::span<uint8_t const> packet) {
+  return packet[1uz] == 0x55u && packet[2uz] == 0xFFu && packet[3uz] == 0xFFu;
+}
+
+/// Get payload of ZPP flash packet
+///
+/// \param  packet  Packet
+/// \return Payload between address and CRC8 trailer
+constexpr std::span<uint8_t const>
+zpp_flash_payload(std::span<uint8_t const> packet) {
+  return packet.subspan(4uz, size(packet) - 4uz - 1uz);
+}
+
+/// Check XOR of ZSU block counter, payload and trailer
+///
+/// \param  block Block
+/// \return true  XOR is 0
+/// \return false Block is corrupt
+constexpr bool zsu_block_valid(std::span<uint8_t const> block) {
+  return !exor(block);
+}
+
+/// Check CRC8 trailer of ZPP flash packet
+///
+/// \param  packet  Packet
+/// \return true    CRC8 matches
+/// \return false   Packet is corrupt
+constexpr bool zpp_flash_packet_valid(std::span<uint8_t const> packet) {
+  return crc8(zpp_flash_payload(packet), 0x55u) == packet.back();
+}
+
+/// Check CRC8 trailer of ZPP CvSet packet (command, subcommand and data)
+///
+/// \param  packet  Packet
+/// \return true    CRC8 matches
+/// \return false   Packet is corrupt
+constexpr bool zpp_cvset_packet_valid(std::span<uint8_t const> packet) {
+  return crc8(packet.first(4uz), 0xAAu) == packet.back();
+}
+
+/// Get stop bit count of ZSU decoder
+///
+/// \param  bootloader_size Bootloader size
+/// \return Decoders with 256 byte bootloaders use 1 stop bit, all others 2
+constexpr uint8_t zsu_stop_bits(size_t bootloader_size) {
+  return bootloader_size == 256uz ? 1u : 2u;
+}
+
+/// Get number of ZSU blocks
+///
+/// \param  count_byte      Block count byte
+/// \param  bootloader_size Bootloader size
+/// \param  block_size      Block size
+/// \return Number of blocks
+constexpr uint16_t
+zsu_block_count(uint8_t count_byte, size_t bootloader_size, size_t block_size) {
+  // For some reason, for PIC16 decoders the normal calculation results in
+  // only half the actual block_count
+  auto const factor{bootloader_size == 256uz ? 2uz : 1uz};
+  return static_cast<uint16_t>(
+    (((count_byte + 1uz) * 256uz - bootloader_size) / block_size) * factor);
+}
+
+/// Check if baud rate can be asked for with a FeatureRequest
+///
+/// \param  baud_rate Baud rate (or 0 for none)
+/// \return true      Multiple of 9600 up to 255 * 9600 (or 0)
+/// \return false     Baud rate can't be encoded in a single byte
+constexpr bool high_speed_valid(uint32_t baud_rate) {
+  return !(baud_rate % baud_rate_unit) && baud_rate / baud_rate_unit <= 0xFFu;
+}
+
+/// Get CvSet FeatureRequest packet asking for a baud rate
+///
+/// \param  baud_rate Baud rate, see \ref high_speed_valid
+/// \return Packet
+constexpr std::array<uint8_t, zpp_cvset_size>
+zpp_high_speed_request(uint32_t baud_rate) {
+  std::array<uint8_t, zpp_cvset_size> packet{
+    std::to_underlying(decup::Command::CvSet),
+    std::to_underlying(decup::CvSetSubcommand::FeatureRequest),
+    feature_baud_rate,
+    static_cast<uint8_t>(baud_rate / baud_rate_unit)};
+  packet.back() = crc8(std::span{packet}.first(4uz), 0xAAu);
+  return packet;
+}
+
+} // namespace ulf::decup_ein::rx::detail
@@ -0,0 +1,61 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive replay
+///
+/// \file   ulf/decup_ein/rx/replay.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <vector>
+#include "async_base.hpp"
+#include "trace.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx Replay class
+///
+/// \details Feeds a recorded Trace back through AsyncBase. Received bytes,
+/// completions and resets are replayed in order, with the recorded pulse
+/// counts standing in for the decoder. Completions recorded from within
+/// transmitAsync are replayed synchronously, so traces of both Base and
+/// AsyncBase backends take the same path through the state machine as during
+/// recording. Every transmission and config the state machine produces is
+/// compared against the trace, differences are counted as mismatches. Baud
+/// rates count as applied if the recorded backend applied them.
+///
+/// Commands issued directly (e.g. readCvs) aren't part of a trace and have to
+/// be repeated by the caller at the same point.
+class Replay : public AsyncBase {
+public:
+  /// Ctor
+  ///
+  /// \param  trace Trace, must stay valid while replaying
+  constexpr explicit Replay(std::span<uint8_t const> trace) : _trace{trace} {}
+
+  /// Dtor
+  virtual constexpr ~Replay() = default;
+
+  bool step();
+  size_t run();
+  size_t mismatches() const;
+
+private:
+  void transmitAsync(std::span<uint8_t const> bytes, uint32_t timeout) final;
+  void config(uint8_t stop_bits) final;
+  bool configUart(uint8_t stop_bits, uint32_t baud_rate) final;
+
+  std::optional<Trace::Record> peek() const;
+  void expect(Trace::Type type,
+              uint32_t value,
+              std::span<uint8_t const> bytes = {});
+
+  std::span<uint8_t const> _trace{};
+  std::vector<uint8_t> _responses{};
+  size_t _mismatches{};
+};
+
+} // namespace ulf::decup_ein::rx
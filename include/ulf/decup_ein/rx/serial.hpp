@@ -0,0 +1,76 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive Linux serial backend
+///
+/// \file   ulf/decup_ein/rx/serial.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <array>
+#include <optional>
+#include "base.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx Serial class
+///
+/// \details Linux backend connecting a host (e.g. USB CDC gadget or socket)
+/// to a decoder on a serial port. Bytes read from the host get passed into
+/// \ref receive(std::span<uint8_t const>, std::span<uint8_t>) straight from
+/// the read buffer, responses are written back. Transmissions are written to
+/// the decoder port, afterwards every byte received from the decoder until
+/// the timeout elapses counts as a pulse. Waiting for pulses is epoll driven
+/// with a timerfd deadline, so timeouts are accurate to microseconds.
+///
+/// File descriptors aren't owned and have to be non-blocking, see \ref raw.
+class Serial : public Base {
+public:
+  /// Size of host read buffer
+  static constexpr size_t buffer_size{64uz * 1024uz};
+
+  /// Timeout for writing transmissions to decoder port [ms]
+  static constexpr int write_timeout{1000};
+
+  Serial(int host, int decoder, uint32_t latency = 0u);
+  Serial(Serial const&) = delete;
+  Serial& operator=(Serial const&) = delete;
+
+  /// Dtor
+  virtual ~Serial();
+
+  bool poll(int timeout = -1);
+  int error() const;
+
+  static bool raw(int fd, uint32_t baud_rate = 0u);
+  static std::optional<uint32_t> termiosSpeed(uint32_t baud_rate);
+  static bool hungup(int fd);
+
+private:
+  uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout) final;
+  void config(uint8_t stop_bits) final;
+  bool configUart(uint8_t stop_bits, uint32_t baud_rate) final;
+
+  bool write(int fd, std::span<uint8_t const> bytes, int timeout);
+  bool fail();
+
+  std::array<uint8_t, buffer_size> _buffer{};
+  std::array<uint8_t, buffer_size> _responses{};
+  int _host{-1};
+  int _decoder{-1};
+  int _host_epoll{-1};
+  int _decoder_epoll{-1};
+  int _timer{-1};
+  int _error{};
+  uint32_t _latency{};
+  std::optional<uint32_t> _default_speed{};
+};
+
+} // namespace ulf::decup_ein::rx
+
+#endif
@@ -0,0 +1,135 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive Linux multi-session server
+///
+/// \file   ulf/decup_ein/rx/server.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "async_base.hpp"
+
+namespace ulf::decup_ein::rx {
+
+/// Rx Server class
+///
+/// \details Multiplexes many independent sessions, each connecting a host to a
+/// decoder port, over a fixed pool of worker threads. While waiting for pulses
+/// a session is parked on its decoder port and a timerfd instead of blocking a
+/// thread. All file descriptors share a single edge-triggered epoll instance.
+/// Ready sessions get queued on the worker which received the event, idle
+/// workers steal from the others. Responses get buffered while the host isn't
+/// ready to take them, so no worker ever blocks on a slow host. Sessions close
+/// once their host hangs up, closed sessions get reused by \ref add.
+///
+/// File descriptors aren't owned and have to be non-blocking, see Serial::raw.
+class Server {
+public:
+  /// Port
+  struct Port {
+    int host{-1};         ///< Host file descriptor
+    int decoder{-1};      ///< Decoder file descriptor
+    uint32_t baud_rate{}; ///< Decoder baud rate, DECUP default (or 0 to ignore
+                          ///< wire time until Options::high_speed switched)
+    uint32_t latency{};   ///< Latency added to every timeout [us]
+  };
+
+  /// Session
+  class alignas(64) Session final : public AsyncBase {
+  public:
+    /// Size of host read buffer
+    static constexpr size_t buffer_size{1024uz};
+
+    explicit Session(Port port);
+    Session(Session const&) = delete;
+    Session& operator=(Session const&) = delete;
+    ~Session();
+
+    bool closed() const;
+
+  private:
+    friend Server;
+
+    /// Size of responses of a single receive
+    static constexpr size_t response_size{64uz};
+
+    /// Scheduling state
+    enum Schedule : uint8_t { Idle, Queued, Running, Again, Closed };
+
+    void open(Port port);
+    void transmitAsync(std::span<uint8_t const> bytes, uint32_t timeout) final;
+    void config(uint8_t stop_bits) final;
+    bool configUart(uint8_t stop_bits, uint32_t baud_rate) final;
+
+    bool run();
+    void pulses();
+    bool flush();
+    bool host();
+
+    // Hot state first, buffer last
+    std::atomic<uint8_t> _schedule{Idle};
+    std::atomic<bool> _closed{};
+    uint8_t _pulse_count{};
+    uint8_t _output_size{};
+    uint8_t _stop_bits{1u};
+    uint16_t _begin{};
+    uint16_t _end{};
+    int _host{-1};
+    int _decoder{-1};
+    int _timer{-1};
+    uint32_t _baud_rate{};
+    uint32_t _default_baud_rate{};
+    uint32_t _latency{};
+    std::optional<uint32_t> _default_speed{};
+    // Responses of receive plus those of a completion while host blocks
+    std::array<uint8_t, response_size + 2uz> _output{};
+    std::array<uint8_t, buffer_size> _buffer{};
+  };
+
+  explicit Server(size_t workers = std::thread::hardware_concurrency());
+  Server(Server const&) = delete;
+  Server& operator=(Server const&) = delete;
+  ~Server();
+
+  Session* add(Port port);
+  size_t sessions() const;
+  size_t steals() const;
+
+private:
+  /// Run queue of worker
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Session*> sessions;
+  };
+
+  void work(size_t worker);
+  void execute(Session* session);
+  void notify(size_t worker, Session* session);
+  Session* pop(size_t worker);
+
+  std::deque<Session> _sessions;
+  std::deque<Queue> _queues;
+  std::mutex _mutex;
+  std::atomic<size_t> _open{};
+  std::atomic<size_t> _steals{};
+  std::atomic<bool> _stopping{};
+  int _epoll{-1};
+  int _event{-1};
+  std::vector<std::jthread> _workers;
+};
+
+} // namespace ulf::decup_ein::rx
+
+#endif
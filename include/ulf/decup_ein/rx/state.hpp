@@ -0,0 +1,39 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive state
+///
+/// \file   ulf/decup_ein/rx/state.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <cstdint>
+
+namespace ulf::decup_ein::rx {
+
+/// Receive state
+enum class State : uint8_t {
+  Entry,
+  Preamble,
+  Zpp,
+  ZppReadCv,
+  ZppWriteCv,
+  ZppFlashErase,
+  ZppFlashWrite,
+  ZppDecoderId,
+  ZppCrcXorQuery,
+  ZppCvSet,
+  ZppCvSetManipulate,
+  ZppCvSetFeatureRequest,
+  ZsuDecoderId,
+  ZsuBlockCount,
+  ZsuSecurityByte1,
+  ZsuSecurityByte2,
+  ZsuBlocks,
+  Count
+};
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,97 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Session trace
+///
+/// \file   ulf/decup_ein/rx/trace.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace ulf::decup_ein::rx {
+
+/// Session trace
+///
+/// \details Records everything passing through AsyncBase into a caller
+/// provided buffer. Each record starts with its type, followed by the time
+/// since the previous record [us] and the payload. Numbers are LEB128 encoded.
+///
+/// | Type         | Payload                          |
+/// | ------------ | -------------------------------- |
+/// | Receive      | Byte                             |
+/// | ReceiveBulk  | Response capacity, size, bytes   |
+/// | Transmit     | Timeout, size, bytes             |
+/// | Complete     | Pulse count                      |
+/// | CompleteSync | Pulse count                      |
+/// | Config       | Stop bits, baud rate             |
+/// | Reset        |                                  |
+///
+/// Config records the baud rate in use afterwards (or 0 for the DECUP
+/// default), which tells replays whether the backend switched. Transmit
+/// records the DECUP timeout, even if AdaptiveTimeouts shortened it, so
+/// replays don't depend on the latencies learned while recording.
+///
+/// Once the buffer is full, recording stops and \ref overflow returns true.
+/// The trace remains a valid prefix of the session.
+class Trace {
+public:
+  /// Record type
+  enum class Type : uint8_t {
+    Receive,      ///< receive(uint8_t)
+    ReceiveBulk,  ///< receive(std::span<uint8_t const>, std::span<uint8_t>)
+    Transmit,     ///< transmitAsync
+    Complete,     ///< complete
+    CompleteSync, ///< complete from within transmitAsync
+    Config,       ///< configUart
+    Reset,        ///< reset
+  };
+
+  /// Parsed record
+  struct Record {
+    Type type{};                      ///< Type
+    uint32_t time{};                  ///< Time since previous record [us]
+    uint32_t value{};                 ///< Byte, capacity, timeout, pulse count
+                                      ///< or stop bits
+    std::span<uint8_t const> bytes{}; ///< Received or transmitted bytes
+    uint32_t baud_rate{};             ///< Baud rate of config
+  };
+
+  /// Ctor
+  ///
+  /// \param  buffer  Buffer
+  constexpr explicit Trace(std::span<uint8_t> buffer) : _buffer{buffer} {}
+
+  void receive(uint8_t byte);
+  void receive(std::span<uint8_t const> bytes, size_t responses);
+  void transmit(std::span<uint8_t const> bytes, uint32_t timeout);
+  void complete(uint8_t pulse_count, bool synchronous);
+  void config(uint8_t stop_bits, uint32_t baud_rate);
+  void reset();
+
+  std::span<uint8_t const> data() const;
+  bool overflow() const;
+  void clear();
+
+  static std::optional<Record> read(std::span<uint8_t const>& trace);
+
+  /// Clock [us]
+  uint32_t (*clock)(){};
+
+private:
+  bool header(Type type, size_t payload_size);
+  void write(uint32_t value);
+  void write(std::span<uint8_t const> bytes);
+
+  std::span<uint8_t> _buffer{};
+  size_t _size{};
+  uint32_t _time{};
+  bool _overflow{};
+};
+
+} // namespace ulf::decup_ein::rx
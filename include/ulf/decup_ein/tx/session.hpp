@@ -0,0 +1,32 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Transmit session types
+///
+/// \file   ulf/decup_ein/tx/session.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace ulf::decup_ein::tx {
+
+/// Spans making up a single transfer
+///
+/// \details Header, payload, padding and trailer. Payloads reference the
+/// firmware or flash image passed to the session, only header and trailer are
+/// generated. Unused spans are empty.
+using Spans = std::array<std::span<uint8_t const>, 4uz>;
+
+/// Progress of block or packet transfer
+struct Progress {
+  size_t count{}; ///< Acknowledged blocks or packets
+  size_t total{}; ///< Total blocks or packets
+};
+
+} // namespace ulf::decup_ein::tx
@@ -0,0 +1,52 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Transmit ZPP session
+///
+/// \file   ulf/decup_ein/tx/zpp_session.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <optional>
+#include "session.hpp"
+
+namespace ulf::decup_ein::tx {
+
+/// Tx ZPP session
+///
+/// \details Generates the host side of a ZPP flash update. Call \ref next to
+/// get the spans of the next transfer, send them and pass the response of the
+/// bridge into \ref response. After the preamble the flash gets erased and
+/// written in packets of 256 bytes. Packets are repeated on single or missing
+/// pulses up to max_retries times.
+class ZppSession {
+public:
+  /// State
+  enum class State : uint8_t { Preamble, FlashErase, FlashWrite, Done, Failed };
+
+  explicit ZppSession(std::span<uint8_t const> flash,
+                      size_t preamble_count = 100uz,
+                      uint8_t max_retries = 3u);
+
+  Spans next();
+  void response(std::optional<uint8_t> response);
+  State state() const;
+  Progress progress() const;
+
+private:
+  void retry();
+
+  std::span<uint8_t const> _flash{};
+  size_t _preamble_count{};
+  size_t _index{};
+  State _state{};
+  uint8_t _max_retries{};
+  uint8_t _retries{};
+  std::array<uint8_t, 4uz> _header{};
+  uint8_t _trailer{};
+};
+
+} // namespace ulf::decup_ein::tx
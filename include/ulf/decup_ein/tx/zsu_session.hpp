@@ -0,0 +1,73 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Transmit ZSU session
+///
+/// \file   ulf/decup_ein/tx/zsu_session.hpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#pragma once
+
+#include <optional>
+#include "session.hpp"
+
+namespace ulf::decup_ein::tx {
+
+/// ZSU firmware
+struct Firmware {
+  uint8_t id{};                  ///< Decoder ID
+  std::span<uint8_t const> bin{}; ///< Binary
+};
+
+/// Tx ZSU session
+///
+/// \details Generates the host side of a ZSU update. Call \ref next to get the
+/// spans of the next transfer, send them and pass the response of the bridge
+/// into \ref response. Decoder IDs of all firmwares are probed in order until
+/// one of them gets acknowledged. Blocks are repeated on single or missing
+/// pulses up to max_retries times. An interrupted upload can be resumed at the
+/// first unacknowledged block of a bridge checkpoint.
+class ZsuSession {
+public:
+  /// State
+  enum class State : uint8_t {
+    Preamble,
+    DecoderId,
+    BlockCount,
+    SecurityByte1,
+    SecurityByte2,
+    Blocks,
+    Done,
+    Failed
+  };
+
+  explicit ZsuSession(std::span<Firmware const> firmwares,
+                      size_t preamble_count = 100uz,
+                      uint8_t max_retries = 3u);
+
+  bool resume(uint8_t decoder_id, size_t block);
+  Spans next();
+  void response(std::optional<uint8_t> response);
+  State state() const;
+  Progress progress() const;
+  std::optional<Firmware> firmware() const;
+
+private:
+  void advance(bool success);
+  void retry();
+
+  std::span<Firmware const> _firmwares{};
+  Firmware _firmware{};
+  size_t _preamble_count{};
+  size_t _index{};
+  size_t _block_size{};
+  State _state{};
+  uint8_t _max_retries{};
+  uint8_t _retries{};
+  uint8_t _header{};
+  uint8_t _trailer{};
+};
+
+} // namespace ulf::decup_ein::tx
@@ -0,0 +1,116 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Adaptive response timeouts
+///
+/// \file   rx/adaptive_timeouts.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/adaptive_timeouts.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace ulf::decup_ein::rx {
+
+namespace {
+
+// Upper bound of bucket, every 2nd one is scaled by 1/sqrt(2)
+constexpr uint32_t upper_bound(size_t bucket, uint32_t max) {
+  auto const steps{AdaptiveTimeouts::buckets - 1uz - bucket};
+  auto const bound{static_cast<uint64_t>(max >> (steps / 2uz))};
+  return static_cast<uint32_t>(steps % 2uz ? bound * 181u / 256u : bound);
+}
+
+} // namespace
+
+/// Get timeout
+///
+/// \param  decoder_id  Decoder ID
+/// \param  state       State
+/// \param  max         DECUP timeout [us]
+/// \return Adapted timeout [us]
+uint32_t
+AdaptiveTimeouts::timeout(uint8_t decoder_id, State state, uint32_t max) const {
+  auto const i{find(decoder_id)};
+  if (i == max_families) return max;
+  auto const& histogram{_families[i].histograms[std::to_underlying(state)]};
+  auto const samples{
+    std::accumulate(cbegin(histogram), cend(histogram), 0uz)};
+  if (!samples || samples < _min_samples) return max;
+  auto const threshold{(samples * _percentile + 99uz) / 100uz};
+  auto sum{0uz};
+  auto bucket{0uz};
+  while ((sum += histogram[bucket]) < threshold) ++bucket;
+  auto const adapted{static_cast<uint64_t>(upper_bound(bucket, max)) *
+                     (100u + _margin) / 100u};
+  return static_cast<uint32_t>(std::min<uint64_t>(adapted, max));
+}
+
+/// Record latency of answered transmission
+///
+/// Histograms saturating get halved, which also lets older samples age out.
+///
+/// \param  decoder_id  Decoder ID
+/// \param  state       State
+/// \param  max         DECUP timeout [us]
+/// \param  latency     Latency [us]
+void AdaptiveTimeouts::record(uint8_t decoder_id,
+                              State state,
+                              uint32_t max,
+                              uint32_t latency) {
+  auto i{find(decoder_id)};
+  if (i == max_families) {
+    auto const it{std::ranges::find(_families, false, &Family::used)};
+    i = static_cast<size_t>(it - cbegin(_families));
+    // Evict families round robin once the table is full
+    if (i == max_families)
+      i = std::exchange(_evict, (_evict + 1uz) % max_families);
+    _families[i] = {.used = true, .decoder_id = decoder_id};
+  }
+  auto& histogram{_families[i].histograms[std::to_underlying(state)]};
+  auto bucket{0uz};
+  while (bucket < buckets - 1uz && latency > upper_bound(bucket, max))
+    ++bucket;
+  if (histogram[bucket] == std::numeric_limits<uint8_t>::max())
+    for (auto& count : histogram) count /= 2u;
+  ++histogram[bucket];
+}
+
+/// Get families (e.g. for persisting)
+///
+/// \return Families
+std::span<AdaptiveTimeouts::Family const> AdaptiveTimeouts::families() const {
+  return _families;
+}
+
+/// Set families (e.g. from persistent storage)
+///
+/// \param  families  Families
+void AdaptiveTimeouts::families(std::span<Family const> families) {
+  clear();
+  std::ranges::copy(families.first(std::min(size(families), max_families)),
+                    begin(_families));
+}
+
+/// Forget all recorded latencies
+void AdaptiveTimeouts::clear() {
+  _families = {};
+  _evict = 0uz;
+}
+
+/// Find family
+///
+/// \param  decoder_id  Decoder ID
+/// \return Index of family or max_families
+size_t AdaptiveTimeouts::find(uint8_t decoder_id) const {
+  auto const it{std::ranges::find_if(_families, [decoder_id](auto&& family) {
+    return family.used && family.decoder_id == decoder_id;
+  })};
+  return static_cast<size_t>(it - cbegin(_families));
+}
+
+} // namespace ulf::decup_ein::rx
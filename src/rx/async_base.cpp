@@ -0,0 +1,1433 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive asynchronous base
+///
+/// \file   rx/async_base.cpp
+/// \author Vincent Hamp
+/// \date   24/10/2024
+
+#include "rx/async_base.hpp"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <functional>
+#include <utility>
+#include "ack.hpp"
+#include "checksum.hpp"
+#include "nak.hpp"
+#include "pulse_count2response.hpp"
+#include "rx/protocol.hpp"
+
+using namespace std::literals;
+
+namespace ulf::decup_ein::rx {
+
+namespace {
+
+// Single writer, so load and store instead of read-modify-write
+template<typename T>
+void add(std::atomic<T>& counter, uint32_t value = 1u) {
+  counter.store(static_cast<T>(counter.load(std::memory_order_relaxed) + value),
+                std::memory_order_relaxed);
+}
+
+// Everything which only depends on the decoder ID
+AsyncBase::SessionInfo zsu_session_info(uint8_t decoder_id) {
+  auto const bootloader_size{decup::decoder_id2bootloader_size(decoder_id)};
+  return {
+    .decoder_id = decoder_id,
+    .stop_bits = detail::zsu_stop_bits(bootloader_size),
+    .block_size =
+      static_cast<uint16_t>(decup::decoder_id2block_size(decoder_id)),
+    .bootloader_size = static_cast<uint16_t>(bootloader_size)};
+}
+
+// Block count and index get published with 12 bits each
+constexpr uint16_t max_block_count{(1u << 12u) - 1u};
+
+// Largest count byte with smallest blocks (and doubled for PIC16) still fits
+static_assert(detail::zsu_block_count(UINT8_MAX, 256uz, 32uz) <=
+              max_block_count);
+
+// Pack decoder ID, block count and block index into a single word
+constexpr uint32_t pack(AsyncBase::SessionInfo const& session) {
+  assert(session.block_count <= max_block_count &&
+         session.block_index <= max_block_count);
+  return uint32_t{session.decoder_id} |
+         uint32_t{session.block_count} << 8u |
+         uint32_t{session.block_index} << 20u;
+}
+
+} // namespace
+
+/// Receive single byte (from e.g. USB)
+///
+/// A queued response of a rejected pipelined ZSU block gets returned first,
+/// the response to byte then takes its place in the queue.
+///
+/// \warning
+/// Must not be called while a transmission is pending, unless it's a ZSU block
+/// and the next block hasn't been received completely yet
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::receive(uint8_t byte) {
+  if (_trace) _trace->receive(byte);
+  auto const response{dispatch(byte)};
+  if (_queued) return std::exchange(_queued, response);
+  return response;
+}
+
+/// Receive bytes (from e.g. USB)
+///
+/// ZSU blocks and ZPP flash packets which are contiguous in bytes are passed to
+/// transmitAsync without copying. So are runs of preamble bytes if
+/// Options::preamble_burst is set, each run only gets a single response.
+/// Payloads of packets straddling transfers are copied in bulk, all other bytes
+/// get dispatched just like \ref receive(uint8_t). Reception stops once either
+/// all bytes are consumed, there is no more space for responses or a
+/// transmission is pending. The only exception to the latter are ZSU blocks,
+/// where the next block gets received while the current one is in flight.
+///
+/// \warning
+/// Bytes must stay valid until a pending transmission got completed.
+///
+/// \param  bytes     Bytes
+/// \param  responses Responses
+/// \return Number of consumed bytes and written responses
+AsyncBase::Result AsyncBase::receive(std::span<uint8_t const> bytes,
+                                     std::span<uint8_t> responses) {
+  if (_trace) _trace->receive(bytes, size(responses));
+  Result retval{};
+  // Response of rejected pipelined ZSU block
+  if (_queued && !empty(responses))
+    responses[retval.out++] = *std::exchange(_queued, std::nullopt);
+  while (retval.in < size(bytes) && retval.out < size(responses)) {
+    // Receive next ZSU block while current one is in flight
+    if (_pending) {
+      if constexpr (zsu_enabled)
+        if (_state == &AsyncBase::zsuBlocks) {
+          auto const count{
+            std::min(payloadSize() - size(_next), size(bytes) - retval.in)};
+          auto const first{begin(bytes) + static_cast<ptrdiff_t>(retval.in)};
+          _next.insert(
+            cend(_next), first, first + static_cast<ptrdiff_t>(count));
+          retval.in += count;
+          if (_metrics || _timeouts) recordReceive(state(), count);
+        }
+      break;
+    }
+    // Drop rest of pipelined ZSU block the host is going to repeat
+    if constexpr (zsu_enabled)
+      if (_discard) {
+        auto const count{std::min(_discard, size(bytes) - retval.in)};
+        retval.in += count;
+        _discard -= count;
+        if (_metrics || _timeouts) recordReceive(state(), count);
+        continue;
+      }
+    // Forward complete packets without copying
+    if (auto const packet{contiguousPacket(bytes.subspan(retval.in))};
+        !empty(packet)) {
+      retval.in += size(packet);
+      if (auto const response{forward(packet)})
+        responses[retval.out++] = *response;
+      continue;
+    }
+    // Copy everything but the last payload byte, the state handles that one
+    if (auto const payload_size{payloadSize()}; payload_size > size(_packet)) {
+      auto const count{std::min(payload_size - size(_packet) - 1uz,
+                                size(bytes) - retval.in)};
+      auto const first{begin(bytes) + static_cast<ptrdiff_t>(retval.in)};
+      _packet.insert(
+        cend(_packet), first, first + static_cast<ptrdiff_t>(count));
+      retval.in += count;
+      if (_metrics || _timeouts) recordReceive(state(), count);
+      if (retval.in == size(bytes)) break;
+    }
+    if (auto const response{dispatch(bytes[retval.in++])})
+      responses[retval.out++] = *response;
+  }
+  return retval;
+}
+
+/// Complete pending transmission
+///
+/// Has to be called by the backend once the transmission started by
+/// transmitAsync is done, either from within transmitAsync itself or later.
+///
+/// \param  pulse_count   Pulse count
+/// \retval std::optional No transmission pending
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::complete(uint8_t pulse_count) {
+  if (_trace) _trace->complete(pulse_count, _transmitting);
+  if (!_pending) return std::nullopt; // Canceled by reset
+  _pending = false;
+  if (_metrics || _timeouts) recordComplete(pulse_count);
+  _response = pulse_count2response(pulse_count);
+  // Callback may override response
+  if (_done) std::exchange(_done, nullptr)(*this, pulse_count);
+  return _response;
+}
+
+/// Take pending response
+///
+/// A corrupt pipelined ZSU block rejected by Options::validate gets answered
+/// right after the block in flight. Backends which complete asynchronously have
+/// to call this after writing the response returned by \ref complete, since
+/// no more data from the host might arrive until they do. Otherwise the next
+/// \ref receive call returns it first.
+///
+/// \retval std::optional No response pending
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::pendingResponse() {
+  return std::exchange(_queued, std::nullopt);
+}
+
+/// Reset
+///
+/// Reset internal state to initial and reconfigure with 1 stop bit. A pending
+/// transmission gets canceled.
+///
+/// \return std::nullopt
+std::optional<uint8_t> AsyncBase::reset() {
+  if (_trace) _trace->reset();
+  resetBackend();
+  _queued = std::nullopt;
+  publishSession({});
+  return restart();
+}
+
+/// Set options
+///
+/// An Options::high_speed which can't be requested gets disabled.
+///
+/// \param  options Options
+void AsyncBase::options(Options options) {
+  if (!detail::high_speed_valid(options.high_speed)) options.high_speed = 0u;
+  _options = options;
+}
+
+/// Get options
+///
+/// \return Options
+AsyncBase::Options AsyncBase::options() const { return _options; }
+
+/// Transmission pending
+///
+/// \retval true  Transmission pending, waiting for \ref complete
+/// \retval false No transmission pending
+bool AsyncBase::pending() const { return _pending; }
+
+/// Get state of current (or last) transmission
+///
+/// \return State transmission got attributed to
+State AsyncBase::transmitState() const { return _transmit_state; }
+
+/// Get current state
+///
+/// \return State
+State AsyncBase::state() const {
+  if (_state == &AsyncBase::entry) return State::Entry;
+  else if (_state == &AsyncBase::preamble) return State::Preamble;
+  // Comparing handlers would keep disabled ones from being discarded
+  if constexpr (zpp_enabled) {
+    if (_state == &AsyncBase::zpp) return State::Zpp;
+    else if (_state == &AsyncBase::zppReadCv) return State::ZppReadCv;
+    else if (_state == &AsyncBase::zppWriteCv) return State::ZppWriteCv;
+    else if (_state == &AsyncBase::zppFlashErase) return State::ZppFlashErase;
+    else if (_state == &AsyncBase::zppFlashWrite) return State::ZppFlashWrite;
+    else if (_state == &AsyncBase::zppDecoderId) return State::ZppDecoderId;
+    else if (_state == &AsyncBase::zppCrcXorQuery)
+      return State::ZppCrcXorQuery;
+  }
+  if constexpr (cvset_enabled) {
+    if (_state == &AsyncBase::zppCvSet) return State::ZppCvSet;
+    else if (_state == &AsyncBase::zppCvSetManipulate)
+      return State::ZppCvSetManipulate;
+    else if (_state == &AsyncBase::zppCvSetFeatureRequest)
+      return State::ZppCvSetFeatureRequest;
+  }
+  if constexpr (zsu_enabled) {
+    if (_state == &AsyncBase::zsuDecoderId) return State::ZsuDecoderId;
+    else if (_state == &AsyncBase::zsuBlockCount) return State::ZsuBlockCount;
+    else if (_state == &AsyncBase::zsuSecurityByte1)
+      return State::ZsuSecurityByte1;
+    else if (_state == &AsyncBase::zsuSecurityByte2)
+      return State::ZsuSecurityByte2;
+  }
+  return State::ZsuBlocks;
+}
+
+/// Attach metrics
+///
+/// \param  metrics Metrics (or nullptr to detach)
+void AsyncBase::metrics(Metrics* metrics) { _metrics = metrics; }
+
+/// Set adaptive timeouts
+///
+/// \param  timeouts  Pointer to adaptive timeouts (or nullptr to disable)
+void AsyncBase::timeouts(AdaptiveTimeouts* timeouts) { _timeouts = timeouts; }
+
+/// Attach trace
+///
+/// \param  trace Trace (or nullptr to detach)
+void AsyncBase::trace(Trace* trace) { _trace = trace; }
+
+/// Read CVs
+///
+/// Runs all ZPP CV reads on the bridge, the host only has to send the
+/// preamble before. Failed reads set their bit in errors (LSB first) and leave
+/// their value at 0.
+///
+/// \warning
+/// CVs, values and errors must stay valid until completion.
+///
+/// \param  cvs           CV addresses (CV number - 1)
+/// \param  values        Values
+/// \param  errors        Error flags, one bit per CV
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack once all CVs got read, Nak if busy or not in
+///                       preamble or ZPP mode
+std::optional<uint8_t> AsyncBase::readCvs(std::span<uint16_t const> cvs,
+                                          std::span<uint8_t> values,
+                                          std::span<uint8_t> errors) {
+  assert(size(cvs) == size(values));
+  if constexpr (zpp_enabled) return zppReadCvs(cvs, 0u, values, errors);
+  else return nak;
+}
+
+/// Read CV range
+///
+/// \warning
+/// Values and errors must stay valid until completion.
+///
+/// \param  first         First CV address (CV number - 1)
+/// \param  values        Values
+/// \param  errors        Error flags, one bit per CV
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack once all CVs got read, Nak if busy or not in
+///                       preamble or ZPP mode
+std::optional<uint8_t> AsyncBase::readCvs(uint16_t first,
+                                          std::span<uint8_t> values,
+                                          std::span<uint8_t> errors) {
+  if constexpr (zpp_enabled) return zppReadCvs({}, first, values, errors);
+  else return nak;
+}
+
+/// Get ZSU session info
+///
+/// Can be polled (e.g. by a UI) to show progress and estimate the remaining
+/// time from block_index and block_count. Safe to call from other tasks, all
+/// fields are loaded at once and so always belong to the same session.
+///
+/// \retval std::optional No ZSU decoder ID acknowledged
+/// \retval SessionInfo   Session info
+std::optional<AsyncBase::SessionInfo> AsyncBase::sessionInfo() const {
+  auto const shared{_shared_session.load(std::memory_order_relaxed)};
+  auto const decoder_id{static_cast<uint8_t>(shared)};
+  if (!decoder_id) return std::nullopt;
+  auto info{zsu_session_info(decoder_id)};
+  info.block_count = static_cast<uint16_t>(shared >> 8u & max_block_count);
+  info.block_index = static_cast<uint16_t>(shared >> 20u);
+  info.byte_count = uint32_t{info.block_count} * uint32_t{info.block_size};
+  return info;
+}
+
+/// Get number of skipped ZPP flash packets
+///
+/// Counts packets acknowledged locally due to Options::skip_erased since the
+/// last successful flash erase.
+///
+/// \return Number of skipped packets
+size_t AsyncBase::skipped() const { return _skipped; }
+
+/// Get ZSU checkpoint
+///
+/// Can be persisted and restored after e.g. a USB reconnect, so that the host
+/// resumes with the first unacknowledged block instead of starting over.
+///
+/// \retval std::optional Not receiving ZSU blocks
+/// \retval Checkpoint    Checkpoint
+std::optional<AsyncBase::Checkpoint> AsyncBase::checkpoint() const {
+  if constexpr (zsu_enabled)
+    if (_state == &AsyncBase::zsuBlocks)
+      return Checkpoint{.decoder_id = _session.decoder_id,
+                        .block = _session.block_index,
+                        .block_count = static_cast<uint16_t>(
+                          _session.block_count - _session.block_index)};
+  return std::nullopt;
+}
+
+/// Restore ZSU checkpoint
+///
+/// Continue receiving ZSU blocks at the block after the last acknowledged one.
+///
+/// \param  checkpoint    Checkpoint
+/// \retval uint8_t       Ack if restored, Nak if busy or checkpoint invalid
+std::optional<uint8_t> AsyncBase::restore(Checkpoint const& checkpoint) {
+  if constexpr (zsu_enabled) {
+    if (_pending || !checkpoint.block_count ||
+        checkpoint.block + checkpoint.block_count > max_block_count ||
+        !decup::decoder_id2block_size(checkpoint.decoder_id))
+      return nak;
+    _packet.clear();
+    _next.clear();
+    _discard = 0uz;
+    _session = zsu_session_info(checkpoint.decoder_id);
+    _session.block_index = checkpoint.block;
+    _session.block_count =
+      static_cast<uint16_t>(checkpoint.block + checkpoint.block_count);
+    _session.byte_count =
+      uint32_t{_session.block_count} * uint32_t{_session.block_size};
+    configure(_session.stop_bits);
+    publishSession(_session);
+    _state = &AsyncBase::zsuBlocks;
+    return ack;
+  } else return nak;
+}
+
+/// Write CVs
+///
+/// Runs a whole ZPP CvSet sequence on the bridge, the host only has to send the
+/// preamble before. CvWriteStart is followed by a ChangePage whenever the upper
+/// byte of the CV address changes, the CvWrites and a final CvWriteEnd. Every
+/// packet gets repeated until it's acknowledged with a double pulse.
+///
+/// \warning
+/// CVs must stay valid until completion.
+///
+/// \param  cvs           CVs
+/// \param  max_retries   Maximum number of retries per packet
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack once all CVs got written, Nak if a packet failed
+///                       or if busy or not in preamble or ZPP mode
+std::optional<uint8_t> AsyncBase::writeCvs(std::span<Cv const> cvs,
+                                           uint8_t max_retries) {
+  if constexpr (cvset_enabled) {
+    if (!zppReady()) return nak;
+    _cv_writes = cvs;
+    _cv_index = 0uz;
+    _cvset_phase = CvSetPhase::Start;
+    _page = 0xFFFFu;
+    _max_retries = max_retries;
+    return zppWriteCvs();
+  } else return nak;
+}
+
+/// Dispatch byte to current state
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::dispatch(uint8_t byte) {
+  assert(!_pending ||
+         (state() == State::ZsuBlocks && size(_next) < payloadSize()));
+  if (!_metrics && !_timeouts) return std::invoke(_state, this, byte);
+  // Byte belongs to the transmission it starts or the state it leads to
+  _unrecorded = 1uz;
+  auto const retval{std::invoke(_state, this, byte)};
+  if (_unrecorded) recordReceive(state(), std::exchange(_unrecorded, 0uz));
+  return retval;
+}
+
+/// Restart
+///
+/// Same as \ref reset, but not traced since it's caused by received data.
+///
+/// \return std::nullopt
+std::optional<uint8_t> AsyncBase::restart() {
+  _packet.clear();
+  _next.clear();
+  _discard = 0uz;
+  _state = &AsyncBase::entry;
+  _done = nullptr;
+  _pending = false;
+  _deferred = {};
+  _values = {};
+  _cv_writes = {};
+  _session = {};
+  _baud_rate = 0u;
+  _negotiating = false;
+  _erased = false;
+  configure(1u);
+  return std::nullopt;
+}
+
+/// Publish session
+///
+/// Store what \ref sessionInfo reports, the session itself gets cleared by
+/// \ref restart once it's done.
+///
+/// \param  session Session
+void AsyncBase::publishSession(SessionInfo const& session) {
+  _shared_session.store(pack(session), std::memory_order_relaxed);
+}
+
+/// Configure with current baud rate
+///
+/// \param  stop_bits Stop bit count
+void AsyncBase::configure(uint8_t stop_bits) {
+  configure(stop_bits, _baud_rate);
+}
+
+/// Configure
+///
+/// The trace records the baud rate in use afterwards, so replays take the
+/// same decisions as the recorded backend.
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+/// \retval true      Baud rate applied
+/// \retval false     Baud rate unsupported by backend
+bool AsyncBase::configure(uint8_t stop_bits, uint32_t baud_rate) {
+  auto const applied{configUart(stop_bits, baud_rate)};
+  if (_trace) _trace->config(stop_bits, applied ? baud_rate : _baud_rate);
+  return applied;
+}
+
+/// Config UART
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+/// \retval true      DECUP default applied
+/// \retval false     Baud rate unsupported
+bool AsyncBase::configUart(uint8_t stop_bits, uint32_t baud_rate) {
+  if (baud_rate) return false;
+  config(stop_bits);
+  return true;
+}
+
+/// Reset backend
+void AsyncBase::resetBackend() {}
+
+/// Start transmission
+///
+/// \param  state         State transmission gets attributed to
+/// \param  bytes         Bytes
+/// \param  timeout       Response timeout [us]
+/// \param  done          Optional callback invoked with pulse count
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::start(State state,
+                                        std::span<uint8_t const> bytes,
+                                        uint32_t timeout,
+                                        Done done) {
+  _done = done;
+  _pending = true;
+  _transmit_state = state;
+  auto const nominal{timeout};
+  if (_metrics || _timeouts) recordStart(timeout);
+  // Probes of other decoders regularly stay unanswered, so a too short probe
+  // timeout could never be detected
+  if (_timeouts) {
+    if (_transmit_state != State::ZsuDecoderId)
+      timeout =
+        _timeouts->timeout(_session.decoder_id, _transmit_state, timeout);
+    _adapted = timeout < _transmit_timeout;
+  }
+  // Completed synchronously and chained, let outermost call transmit
+  if (_transmitting) {
+    _deferred = bytes;
+    _deferred_timeout = timeout;
+    _deferred_nominal = nominal;
+    return std::nullopt;
+  }
+  _transmitting = true;
+  if (_trace) _trace->transmit(bytes, nominal);
+  transmitAsync(bytes, timeout);
+  while (!empty(_deferred)) {
+    if (_trace) _trace->transmit(_deferred, _deferred_nominal);
+    transmitAsync(std::exchange(_deferred, {}), _deferred_timeout);
+  }
+  _transmitting = false;
+  // Synchronous backends complete right away
+  return _pending ? std::nullopt : _response;
+}
+
+/// Start transmission of single byte
+///
+/// \param  state         State transmission gets attributed to
+/// \param  byte          Byte
+/// \param  timeout       Response timeout [us]
+/// \param  done          Optional callback invoked with pulse count
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t>
+AsyncBase::start(State state, uint8_t byte, uint32_t timeout, Done done) {
+  _byte = byte;
+  return start(state, {&_byte, sizeof(_byte)}, timeout, done);
+}
+
+/// Reject packet with corrupt checksum without transmitting it
+///
+/// \param  state   State packet gets attributed to
+/// \param  done    Optional callback invoked with single pulse
+/// \return Nak
+std::optional<uint8_t> AsyncBase::reject(State state, Done done) {
+  if (_metrics || _timeouts) recordLocal(state, 1u);
+  if (done) done(*this, 1u);
+  return nak;
+}
+
+/// Entry
+///
+/// Skips additional DECUP_EIN strings should they occur.
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::entry(uint8_t byte) {
+  // Ignore entry string which might occur multiple times...
+  if (detail::entry(byte)) return std::nullopt;
+  _state = &AsyncBase::preamble;
+  return preamble(byte);
+}
+
+/// Preamble
+///
+/// Transmit any preamble, continue with either zpp or zsu.
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::preamble(uint8_t byte) {
+  // Still Preamble?
+  if (detail::preamble(byte))
+    return start(State::Preamble, byte, decup::Timeouts::zpp_preamble);
+  // Continue with ZPP
+  else if (byte < 0x80u) {
+    if constexpr (zpp_enabled) {
+      // Pretty sure, no decoder with ZPP causes problems with 2 stop bits
+      configure(2u);
+      _state = &AsyncBase::zpp;
+      return zpp(byte);
+    }
+  }
+  // Continue with ZSU
+  else {
+    if constexpr (zsu_enabled) {
+      _state = &AsyncBase::zsuDecoderId;
+      return zsuDecoderId(byte);
+    }
+  }
+  return std::nullopt;
+}
+
+#if ULF_DECUP_EIN_ZPP
+/// ZPP
+///
+/// \note
+/// ---> [Command]
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zpp(uint8_t byte) {
+  _packet.clear();
+  switch (detail::zpp_command2state(byte)) {
+    case State::ZppReadCv:
+      _state = &AsyncBase::zppReadCv;
+      return zppReadCv(byte);
+    case State::ZppWriteCv:
+      _state = &AsyncBase::zppWriteCv;
+      return zppWriteCv(byte);
+    case State::ZppFlashErase:
+      _state = &AsyncBase::zppFlashErase;
+      return zppFlashErase(byte);
+    case State::ZppFlashWrite:
+      _state = &AsyncBase::zppFlashWrite;
+      return zppFlashWrite(byte);
+    case State::ZppDecoderId:
+      _state = &AsyncBase::zppDecoderId;
+      return zppDecoderId(byte);
+    case State::ZppCrcXorQuery:
+      _state = &AsyncBase::zppCrcXorQuery;
+      return zppCrcXorQuery(byte);
+    case State::ZppCvSet:
+      if constexpr (cvset_enabled) {
+        _state = &AsyncBase::zppCvSet;
+        return zppCvSet(byte);
+      }
+      break;
+    default: break;
+  }
+  return std::nullopt;
+}
+
+/// ZPP Read Cv
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppReadCv(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) < detail::zpp_cv_read_size) return std::nullopt;
+  else if (size(_packet) == detail::zpp_cv_read_size)
+    return _options.assemble_bits
+             ? zppBits(State::ZppReadCv, _packet, decup::Timeouts::zpp_cv_read)
+             : start(State::ZppReadCv, _packet, decup::Timeouts::zpp_cv_read);
+  if (size(_packet) == detail::zpp_cv_read_size + detail::zpp_dummy_count)
+    _state = &AsyncBase::zpp;
+  return start(State::ZppReadCv, byte, decup::Timeouts::zpp_cv_read);
+}
+
+/// ZPP Write Cv
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppWriteCv(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) == detail::zpp_cv_write_size(_packet[0uz])) {
+    _state = &AsyncBase::zpp;
+    return start(State::ZppWriteCv, _packet, decup::Timeouts::zpp_cv_write);
+  }
+  return std::nullopt;
+}
+
+/// ZPP Erase Flash
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppFlashErase(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) == detail::zpp_flash_erase_size &&
+      detail::zpp_flash_erase_valid(_packet)) {
+    _state = &AsyncBase::zpp;
+    return start(State::ZppFlashErase,
+                 _packet,
+                 decup::Timeouts::zpp_flash_erase,
+                 &AsyncBase::zppFlashErased);
+  } else if (size(_packet) >= detail::zpp_flash_erase_size)
+    _state = &AsyncBase::zpp; // Incorrect security bytes
+  return std::nullopt;
+}
+
+/// ZPP Write Flash
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppFlashWrite(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) == DECUP_MAX_PACKET_SIZE) {
+    _state = &AsyncBase::zpp;
+    return zppFlashPacket(_packet);
+  }
+  return std::nullopt;
+}
+
+/// ZPP Flash packet
+///
+/// \param  packet        Packet
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t>
+AsyncBase::zppFlashPacket(std::span<uint8_t const> packet) {
+  if (_options.validate && !detail::zpp_flash_packet_valid(packet))
+    return reject(State::ZppFlashWrite);
+  // Erased flash already reads 0xFF
+  if (_options.skip_erased && _erased &&
+      erased(detail::zpp_flash_payload(packet))) {
+    ++_skipped;
+    if (_metrics || _timeouts) recordLocal(State::ZppFlashWrite, 2u);
+    return ack;
+  }
+  return start(State::ZppFlashWrite, packet, decup::Timeouts::zpp_flash_write);
+}
+
+/// ZPP Decoder ID
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppDecoderId(uint8_t byte) {
+  _packet.push_back(byte);
+  if (_options.assemble_bits)
+    return zppBits(
+      State::ZppDecoderId, _packet, decup::Timeouts::zpp_decoder_id);
+  if (size(_packet) == 1uz + detail::zpp_dummy_count)
+    _state = &AsyncBase::zpp;
+  return start(State::ZppDecoderId, byte, decup::Timeouts::zpp_decoder_id);
+}
+
+/// ZPP CRC or XOR Query
+///
+/// \deprecated
+/// This command is deprecated, use with care
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppCrcXorQuery(uint8_t byte) {
+  _packet.push_back(byte);
+  if (_options.assemble_bits)
+    return zppBits(
+      State::ZppCrcXorQuery, _packet, decup::Timeouts::zpp_crc_or_xor);
+  if (size(_packet) == 1uz + detail::zpp_dummy_count)
+    _state = &AsyncBase::zpp;
+  return start(State::ZppCrcXorQuery, byte, decup::Timeouts::zpp_crc_or_xor);
+}
+
+/// ZPP bits
+///
+/// Transmit packet and the 7 dummy bytes following it locally, then answer
+/// with the assembled byte. Bits are sent MSB first, a double pulse is a 1.
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  state         State transmissions get attributed to
+/// \param  packet        Packet
+/// \param  timeout       Response timeout [us]
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Assembled byte
+std::optional<uint8_t> AsyncBase::zppBits(State state,
+                                          std::span<uint8_t const> packet,
+                                          uint32_t timeout) {
+  _state = &AsyncBase::zpp;
+  _bits = _bit_count = 0u;
+  _bit_timeout = timeout;
+  return start(state, packet, timeout, &AsyncBase::zppBit);
+}
+
+/// ZPP bit
+///
+/// Shift bit into assembled byte and transmit next dummy byte. Missing or
+/// invalid answers abort with Nak.
+///
+/// \param  self          Self
+/// \param  pulse_count   Pulse count
+void AsyncBase::zppBit(AsyncBase& self, uint8_t pulse_count) {
+  self._response = std::nullopt;
+  auto const valid{pulse_count == 1u || pulse_count == 2u};
+  if (valid) {
+    self._bits = static_cast<uint8_t>(self._bits << 1u | (pulse_count == 2u));
+    if (++self._bit_count < CHAR_BIT) {
+      self.start(self._transmit_state,
+                 0xFFu,
+                 self._bit_timeout,
+                 &AsyncBase::zppBit);
+      return;
+    }
+    self._response = self._bits;
+  } else self._response = nak;
+  // Part of readCvs
+  if (!empty(self._values)) self.zppReadCvsNext(valid);
+  // Part of high speed negotiation
+  else if (self._negotiating) self.zppHighSpeedNext(valid);
+}
+
+/// ZPP flash erased
+///
+/// Remember successful erase and negotiate Options::high_speed if requested.
+///
+/// \param  self          Self
+/// \param  pulse_count   Pulse count
+void AsyncBase::zppFlashErased(AsyncBase& self, uint8_t pulse_count) {
+  if (pulse_count != 2u) return;
+  self._erased = true;
+  self._skipped = 0uz;
+  if (self._options.high_speed && !self._baud_rate) self.zppHighSpeed();
+}
+
+/// ZPP high speed
+///
+/// Ask decoder for Options::high_speed with a FeatureRequest. The erase stays
+/// unanswered until the request is done. Backends which can't switch to the
+/// baud rate don't ask at all, others get switched back for the request.
+void AsyncBase::zppHighSpeed() {
+  if (!configure(2u, _options.high_speed)) return;
+  configure(2u);
+  _response = std::nullopt;
+  _negotiating = true;
+  auto const request{detail::zpp_high_speed_request(_options.high_speed)};
+  _packet.clear();
+  _packet.insert(cend(_packet), cbegin(request), cend(request));
+  zppBits(State::ZppCvSetFeatureRequest, _packet, decup::Timeouts::zpp_cvset);
+}
+
+/// ZPP high speed next
+///
+/// Switch baud rate if the decoder echoed the requested one. Naks, missing
+/// answers or any other value keep the DECUP default. Either way the erase
+/// gets acked.
+///
+/// \param  valid         Assembled byte is valid
+void AsyncBase::zppHighSpeedNext(bool valid) {
+  _negotiating = false;
+  // Request is still in packet
+  if (auto const requested{_packet[3uz]}; valid && _bits == requested) {
+    _baud_rate = requested * detail::baud_rate_unit;
+    configure(2u);
+  }
+  _response = ack;
+}
+
+/// ZPP read CVs
+///
+/// \param  cvs           CV addresses or empty for range
+/// \param  first         First CV address of range
+/// \param  values        Values
+/// \param  errors        Error flags, one bit per CV
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack once all CVs got read, Nak if busy or not in
+///                       preamble or ZPP mode
+std::optional<uint8_t> AsyncBase::zppReadCvs(std::span<uint16_t const> cvs,
+                                             uint16_t first,
+                                             std::span<uint8_t> values,
+                                             std::span<uint8_t> errors) {
+  assert(size(errors) * CHAR_BIT >= size(values));
+  if (!zppReady()) return nak;
+  else if (empty(values)) return ack;
+  std::ranges::fill(errors, 0u);
+  _cvs = cvs;
+  _first_cv = first;
+  _values = values;
+  _errors = errors;
+  _cv_index = 0uz;
+  return zppReadCvs();
+}
+
+/// ZPP read CVs
+///
+/// Start reading next CV or answer with Ack once all were read.
+///
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack
+std::optional<uint8_t> AsyncBase::zppReadCvs() {
+  if (_cv_index == size(_values)) {
+    _values = {};
+    return _response = ack;
+  }
+  auto const cv{empty(_cvs) ? static_cast<uint16_t>(_first_cv + _cv_index)
+                            : _cvs[_cv_index]};
+  _packet.clear();
+  _packet.push_back(std::to_underlying(decup::Command::CvRead));
+  _packet.push_back(static_cast<uint8_t>(cv >> 0u));
+  _packet.push_back(static_cast<uint8_t>(cv >> 8u));
+  return zppBits(State::ZppReadCv, _packet, decup::Timeouts::zpp_cv_read);
+}
+
+#  if ULF_DECUP_EIN_CVSET
+/// ZPP write CVs
+///
+/// Transmit next packet of CvSet sequence or answer with Ack once done.
+///
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack
+std::optional<uint8_t> AsyncBase::zppWriteCvs() {
+  using enum decup::CvSetSubcommand;
+  _retries = 0u;
+  switch (_cvset_phase) {
+    case CvSetPhase::Start:
+      _cvset_phase = empty(_cv_writes) ? CvSetPhase::End : CvSetPhase::Write;
+      return zppCvSetPacket(CvWriteStart, 0u, 0u);
+    case CvSetPhase::Write: {
+      auto const cv{_cv_writes[_cv_index]};
+      if (auto const page{static_cast<uint16_t>(cv.address >> 8u)};
+          page != _page) {
+        _page = page;
+        return zppCvSetPacket(ChangePage, static_cast<uint8_t>(page), 0u);
+      }
+      if (++_cv_index == size(_cv_writes)) _cvset_phase = CvSetPhase::End;
+      return zppCvSetPacket(
+        CvWrite, static_cast<uint8_t>(cv.address), cv.value);
+    }
+    case CvSetPhase::End:
+      _cvset_phase = CvSetPhase::Done;
+      return zppCvSetPacket(CvWriteEnd, 0u, 0u);
+    case CvSetPhase::Done: break;
+  }
+  _cv_writes = {};
+  return _response = ack;
+}
+
+/// ZPP CvSet packet
+///
+/// \param  subcommand    Subcommand
+/// \param  data0         First data byte
+/// \param  data1         Second data byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Ack once all CVs got written, Nak if a packet failed
+std::optional<uint8_t> AsyncBase::zppCvSetPacket(
+  decup::CvSetSubcommand subcommand, uint8_t data0, uint8_t data1) {
+  _packet.clear();
+  _packet.push_back(std::to_underlying(decup::Command::CvSet));
+  _packet.push_back(std::to_underlying(subcommand));
+  _packet.push_back(data0);
+  _packet.push_back(data1);
+  _packet.push_back(crc8(_packet, 0xAAu));
+  return start(State::ZppCvSetManipulate,
+               _packet,
+               decup::Timeouts::zpp_cvset,
+               &AsyncBase::zppCvSetAck);
+}
+
+/// ZPP CvSet acknowledge
+///
+/// Continue with next packet on double pulse, repeat packet otherwise.
+///
+/// \param  self          Self
+/// \param  pulse_count   Pulse count
+void AsyncBase::zppCvSetAck(AsyncBase& self, uint8_t pulse_count) {
+  self._response = std::nullopt;
+  if (pulse_count == 2u) self.zppWriteCvs();
+  else if (self._retries++ < self._max_retries)
+    self.start(self._transmit_state,
+               self._packet,
+               decup::Timeouts::zpp_cvset,
+               &AsyncBase::zppCvSetAck);
+  else {
+    self._cv_writes = {};
+    self._response = nak;
+  }
+}
+
+#  endif
+
+/// ZPP ready
+///
+/// Leave preamble for ZPP if necessary.
+///
+/// \retval true   In ZPP mode and no transmission pending
+/// \retval false  Busy or in other mode
+bool AsyncBase::zppReady() {
+  if (_pending) return false;
+  // Continue with ZPP
+  else if (_state == &AsyncBase::preamble) {
+    configure(2u);
+    _state = &AsyncBase::zpp;
+  }
+  return _state == &AsyncBase::zpp;
+}
+
+/// ZPP read CVs next
+///
+/// Store value or error flag of current CV and continue with next one.
+///
+/// \param  valid CV read successfully
+void AsyncBase::zppReadCvsNext(bool valid) {
+  _values[_cv_index] = valid ? _bits : 0u;
+  if (!valid)
+    _errors[_cv_index / CHAR_BIT] |=
+      static_cast<uint8_t>(1u << (_cv_index % CHAR_BIT));
+  ++_cv_index;
+  _response = std::nullopt;
+  zppReadCvs();
+}
+
+#  if ULF_DECUP_EIN_CVSET
+/// ZPP CvSet Command set
+///
+/// \note
+/// Dispatch to either zppCvSetManipulate or zppCvSetFeatureRequest
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+std::optional<uint8_t> AsyncBase::zppCvSet(uint8_t byte) {
+  // Check if command or subcommand
+  if (size(_packet) == 1uz) {
+    switch (detail::zpp_cvset_subcommand2state(byte)) {
+      case State::ZppCvSetManipulate:
+        _state = &AsyncBase::zppCvSetManipulate;
+        return zppCvSetManipulate(byte);
+      case State::ZppCvSetFeatureRequest:
+        _state = &AsyncBase::zppCvSetFeatureRequest;
+        return zppCvSetFeatureRequest(byte);
+      default: break;
+    }
+  }
+  _packet.push_back(byte);
+  return std::nullopt;
+}
+
+/// ZPP CvSet Manipulate
+///
+/// \note
+/// After transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppCvSetManipulate(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) == detail::zpp_cvset_size) {
+    _state = &AsyncBase::zpp;
+    if (_options.validate && !detail::zpp_cvset_packet_valid(_packet))
+      return reject(State::ZppCvSetManipulate);
+    return start(
+      State::ZppCvSetManipulate, _packet, decup::Timeouts::zpp_cvset);
+  }
+  return std::nullopt;
+}
+
+/// ZPP CvSet Feature Request
+///
+/// \note
+/// After last transmission ---> ZPP
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zppCvSetFeatureRequest(uint8_t byte) {
+  _packet.push_back(byte);
+  if (size(_packet) < detail::zpp_cvset_size) return std::nullopt;
+  else if (size(_packet) == detail::zpp_cvset_size) {
+    // Corrupt packet, skip dummy bytes
+    if (_options.validate && !detail::zpp_cvset_packet_valid(_packet)) {
+      _state = &AsyncBase::zpp;
+      return reject(State::ZppCvSetFeatureRequest);
+    }
+    // Packet
+    return _options.assemble_bits
+             ? zppBits(State::ZppCvSetFeatureRequest,
+                       _packet,
+                       decup::Timeouts::zpp_cvset)
+             : start(State::ZppCvSetFeatureRequest,
+                     _packet,
+                     decup::Timeouts::zpp_cvset);
+  }
+  // Dummy Bytes
+  if (size(_packet) == detail::zpp_cvset_size + detail::zpp_dummy_count)
+    _state = &AsyncBase::zpp;
+  return start(
+    State::ZppCvSetFeatureRequest, byte, decup::Timeouts::zpp_cvset);
+}
+
+#  endif
+#endif
+
+#if ULF_DECUP_EIN_ZSU
+/// ZSU Decoder ID
+///
+/// \note
+/// Double pulse ---> ZSU block count
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuDecoderId(uint8_t byte) {
+  return start(State::ZsuDecoderId,
+               byte,
+               decup::Timeouts::zsu_decoder_id,
+               [](AsyncBase& self, uint8_t pulse_count) {
+                 if (pulse_count != 2uz) return;
+                 self._state = &AsyncBase::zsuBlockCount;
+                 self._session = zsu_session_info(self._byte);
+                 self.publishSession(self._session);
+               });
+}
+
+/// ZSU block count
+///
+/// \note
+/// Single pulse ---> ZSU SecurityByte1
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuBlockCount(uint8_t byte) {
+  return start(
+    State::ZsuBlockCount,
+    byte,
+    decup::Timeouts::zsu_page_count,
+    [](AsyncBase& self, uint8_t pulse_count) {
+      if (pulse_count != 1uz) return;
+      self._state = &AsyncBase::zsuSecurityByte1;
+      auto const count_byte{self._byte};
+      assert(count_byte > 8u + 1u);
+      auto& session{self._session};
+      self.configure(session.stop_bits);
+      session.block_count = detail::zsu_block_count(
+        count_byte, session.bootloader_size, session.block_size);
+      session.block_index = 0u;
+      session.byte_count =
+        uint32_t{session.block_count} * uint32_t{session.block_size};
+      self.publishSession(session);
+    });
+}
+
+/// ZSU SecurityByte 1
+///
+/// \note
+/// Single pulse ---> ZSU SecurityByte2
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuSecurityByte1(uint8_t byte) {
+  if (byte != 0x55u) return restart();
+  return start(State::ZsuSecurityByte1,
+               byte,
+               decup::Timeouts::zsu_security_bytes,
+               [](AsyncBase& self, uint8_t pulse_count) {
+                 if (pulse_count == 1uz)
+                   self._state = &AsyncBase::zsuSecurityByte2;
+               });
+}
+
+/// ZSU SecurityByte 2
+///
+/// \note
+/// Single pulse ---> ZSU Blocks
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuSecurityByte2(uint8_t byte) {
+  if (byte != 0xAAu) return restart();
+  return start(State::ZsuSecurityByte2,
+               byte,
+               decup::Timeouts::zsu_security_bytes,
+               [](AsyncBase& self, uint8_t pulse_count) {
+                 if (pulse_count == 1uz) self._state = &AsyncBase::zsuBlocks;
+               });
+}
+
+/// ZSU Blocks
+///
+/// Depending on ID, either 32 or 64 Byte blocks are transmitted.
+///
+/// While a block is in flight, the next one gets received into a second
+/// buffer. It's transmitted as soon as the current one got acknowledged.
+///
+/// \note
+/// Double pulse ---> Next packet
+/// Single pulse ---> Repeat packet
+///
+/// \param  byte          Byte
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuBlocks(uint8_t byte) {
+  // Current block in flight
+  if (_pending) {
+    _next.push_back(byte);
+    return std::nullopt;
+  }
+
+  // Rest of pipelined block the host is going to repeat
+  if (_discard) {
+    --_discard;
+    return std::nullopt;
+  }
+
+  _packet.push_back(byte);
+
+  // Not enough bytes
+  if (size(_packet) < payloadSize()) return std::nullopt;
+
+  return zsuBlock(_packet);
+}
+
+/// ZSU Block
+///
+/// Transmit block. A pipelined block gets dropped on a single pulse, since the
+/// host is going to repeat both of them. If it's only partially received, its
+/// remaining bytes get dropped as well. A corrupt pipelined block rejected by
+/// Options::validate can't be answered by the same \ref complete call, its Nak
+/// gets queued and is returned by \ref pendingResponse instead.
+///
+/// \warning
+/// Pipelining requires a backend which completes asynchronously, otherwise
+/// the response of the pipelined block gets lost.
+///
+/// \param  block         Block
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::zsuBlock(std::span<uint8_t const> block) {
+  constexpr Done done{[](AsyncBase& self, uint8_t pulse_count) {
+    // Whatever happens after that, clear the packet
+    self._packet.clear();
+    // Host repeats packet
+    if (pulse_count != 2uz) {
+      if (!empty(self._next))
+        self._discard = self.payloadSize() - size(self._next);
+      self._next.clear();
+      return;
+    }
+    ++self._session.block_index;
+    self.publishSession(self._session);
+    // Last packet transmitted successfully
+    if (self._session.block_index == self._session.block_count)
+      self.restart();
+    // Continue with pipelined packet
+    else {
+      std::swap(self._packet, self._next);
+      if (size(self._packet) == self.payloadSize())
+        self._queued = self.zsuBlock(self._packet);
+    }
+  }};
+  if (_options.validate && !detail::zsu_block_valid(block))
+    return reject(State::ZsuBlocks, done);
+  return start(State::ZsuBlocks, block, decup::Timeouts::zsu_blocks, done);
+}
+
+#endif
+
+/// Payload size
+///
+/// \return Size of ZSU block or ZPP flash packet currently being received, 0
+///         otherwise
+size_t AsyncBase::payloadSize() const {
+  if constexpr (zsu_enabled)
+    if (_state == &AsyncBase::zsuBlocks)
+      return _session.block_size + detail::zsu_block_overhead;
+  if constexpr (zpp_enabled)
+    if (_state == &AsyncBase::zppFlashWrite) return DECUP_MAX_PACKET_SIZE;
+  return 0uz;
+}
+
+/// Contiguous packet
+///
+/// \param  bytes Bytes
+/// \return Complete ZSU block, ZPP flash packet or run of preamble bytes at
+///         the start of bytes, empty span otherwise
+std::span<uint8_t const>
+AsyncBase::contiguousPacket(std::span<uint8_t const> bytes) const {
+  if (_options.preamble_burst &&
+      (_state == &AsyncBase::entry || _state == &AsyncBase::preamble)) {
+    auto const it{std::ranges::find_if_not(bytes, detail::preamble)};
+    return bytes.first(static_cast<size_t>(it - cbegin(bytes)));
+  }
+  if constexpr (zsu_enabled)
+    if (_state == &AsyncBase::zsuBlocks && empty(_packet) &&
+        size(bytes) >= payloadSize())
+      return bytes.first(payloadSize());
+  if constexpr (zpp_enabled)
+    if (_state == &AsyncBase::zpp && size(bytes) >= DECUP_MAX_PACKET_SIZE &&
+        bytes[0uz] == std::to_underlying(decup::Command::WriteFlash))
+      return bytes.first(DECUP_MAX_PACKET_SIZE);
+  return {};
+}
+
+/// Forward packet without copying
+///
+/// \param  packet        ZSU block, ZPP flash packet or run of preamble bytes
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Pulse count
+std::optional<uint8_t> AsyncBase::forward(std::span<uint8_t const> packet) {
+  // Preamble burst
+  if (_state == &AsyncBase::entry || _state == &AsyncBase::preamble) {
+    _state = &AsyncBase::preamble;
+    if (_metrics || _timeouts) recordReceive(State::Preamble, size(packet));
+    return start(State::Preamble, packet, decup::Timeouts::zpp_preamble);
+  }
+  // ZSU block
+  if constexpr (zsu_enabled)
+    if (!zpp_enabled || _state == &AsyncBase::zsuBlocks) {
+      if (_metrics || _timeouts)
+        recordReceive(State::ZsuBlocks, size(packet));
+      return zsuBlock(packet);
+    }
+  // ZPP flash packet
+  if constexpr (zpp_enabled) {
+    if (_metrics || _timeouts)
+      recordReceive(State::ZppFlashWrite, size(packet));
+    _packet.clear();
+    return zppFlashPacket(packet);
+  }
+  return std::nullopt;
+}
+
+/// Record received bytes
+///
+/// \param  state State
+/// \param  count Number of bytes
+void AsyncBase::recordReceive(State state, size_t count) {
+  if (!_metrics) return;
+  add(_metrics->counters[std::to_underlying(state)].bytes,
+      static_cast<uint32_t>(count));
+}
+
+/// Record packet answered locally without transmitting it
+///
+/// \param  state       State
+/// \param  pulse_count Pulse count of local answer
+void AsyncBase::recordLocal(State state, uint8_t pulse_count) {
+  if (_unrecorded) recordReceive(state, std::exchange(_unrecorded, 0uz));
+  if (!_metrics) return;
+  auto& counters{_metrics->counters[std::to_underlying(state)]};
+  add(pulse_count == 2u ? counters.acks : counters.naks);
+}
+
+/// Get clock of metrics or adaptive timeouts
+///
+/// \return Clock (or nullptr)
+AsyncBase::Clock AsyncBase::clock() const {
+  if (_metrics && _metrics->clock) return _metrics->clock;
+  return _timeouts ? _timeouts->clock : nullptr;
+}
+
+/// Record start of transmission
+///
+/// \param  timeout DECUP timeout [us]
+void AsyncBase::recordStart(uint32_t timeout) {
+  if (_unrecorded)
+    recordReceive(_transmit_state, std::exchange(_unrecorded, 0uz));
+  _transmit_timeout = timeout;
+  if (auto const clock{this->clock()}) _transmit_time = clock();
+}
+
+/// Record completion of transmission
+///
+/// \param  pulse_count Pulse count
+void AsyncBase::recordComplete(uint8_t pulse_count) {
+  auto const clock{this->clock()};
+  auto const latency{clock ? clock() - _transmit_time : 0u};
+
+  // Answered transmissions tell something about the decoder, so do misses
+  // under an adapted timeout which might just have been too short. Those go
+  // into the top bucket, otherwise the timeout could never widen again. ZSU
+  // decoder ID probes are never adapted and so not recorded either.
+  if (_timeouts && clock && _transmit_state != State::ZsuDecoderId) {
+    if (pulse_count == 1u || pulse_count == 2u)
+      _timeouts->record(
+        _session.decoder_id, _transmit_state, _transmit_timeout, latency);
+    else if (_adapted)
+      _timeouts->record(_session.decoder_id,
+                        _transmit_state,
+                        _transmit_timeout,
+                        _transmit_timeout);
+  }
+
+  if (!_metrics) return;
+  auto& counters{_metrics->counters[std::to_underlying(_transmit_state)]};
+  if (pulse_count == 2u) add(counters.acks);
+  else if (pulse_count == 1u) add(counters.naks);
+  else add(counters.timeouts);
+  if (!_metrics->clock) return;
+  add(counters.time, latency);
+  auto const bucket{
+    _transmit_timeout
+      ? std::min<size_t>(static_cast<uint64_t>(latency) * Metrics::buckets /
+                           _transmit_timeout,
+                         Metrics::buckets - 1uz)
+      : Metrics::buckets - 1uz};
+  add(counters.latencies[bucket]);
+}
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,210 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive broadcast
+///
+/// \file   rx/broadcast.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/broadcast.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace ulf::decup_ein::rx {
+
+/// Ctor
+///
+/// \param  channels    Number of channels
+/// \param  max_retries Maximum number of retries per transmission and channel
+Broadcast::Broadcast(size_t channels, uint8_t max_retries)
+  : _max_retries{max_retries} {
+  this->channels(channels);
+}
+
+/// Complete pending transmission on a single channel
+///
+/// \param  channel       Channel
+/// \param  pulse_count   Pulse count
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Aggregated pulse count
+std::optional<uint8_t> Broadcast::complete(size_t channel,
+                                           uint8_t pulse_count) {
+  assert(channel < _channels);
+  auto const mask{1ull << channel};
+  if (!(_outstanding & mask)) return std::nullopt;
+  _outstanding &= ~mask;
+  _pulse_counts[channel] = pulse_count;
+  if (_outstanding) return std::nullopt;
+  return aggregate();
+}
+
+/// Aggregate pulse counts of all active channels
+///
+/// \retval std::optional No result (yet)
+/// \retval uint8_t       Aggregated pulse count
+std::optional<uint8_t> Broadcast::aggregate() {
+  auto const pulse_count_majority{majority()};
+
+  // Pulse counts carry data, channels which disagree are out of sync
+  if (!repeatable()) {
+    if (pulse_count_majority)
+      for (auto i{0uz}; i < _channels; ++i)
+        if (active() & (1ull << i) &&
+            _pulse_counts[i] != pulse_count_majority)
+          _failed |= 1ull << i;
+    return AsyncBase::complete(pulse_count_majority);
+  }
+
+  // Repeat channels which answered with a single pulse
+  uint64_t repeat{};
+  if (pulse_count_majority == 2u)
+    for (auto i{0uz}; i < _channels; ++i)
+      if (active() & (1ull << i) && _pulse_counts[i] == 1u &&
+          _repeats[i] < _max_retries) {
+        repeat |= 1ull << i;
+        ++_repeats[i];
+        ++_retries[i];
+      }
+  if (repeat) {
+    _outstanding = repeat;
+    for (auto i{0uz}; i < _channels; ++i)
+      if (repeat & (1ull << i)) transmitChannel(i, _bytes, _timeout);
+    return std::nullopt;
+  }
+
+  // Channels which still disagree with a double pulse majority or didn't
+  // answer at all have failed
+  if (pulse_count_majority)
+    for (auto i{0uz}; i < _channels; ++i)
+      if (active() & (1ull << i) &&
+          (pulse_count_majority == 2u ? _pulse_counts[i] != 2u
+                                      : !_pulse_counts[i]))
+        _failed |= 1ull << i;
+
+  // Those answering a single pulse majority with a double pulse are ahead,
+  // remember the packet to skip the host's repeat of it
+  if (pulse_count_majority == 1u)
+    for (auto i{0uz}; i < _channels; ++i)
+      if (active() & (1ull << i) && _pulse_counts[i] == 2u) _ahead |= 1ull << i;
+  if (_ahead) {
+    if (size(_bytes) <= size(_accepted)) {
+      std::ranges::copy(_bytes, begin(_accepted));
+      _accepted_size = size(_bytes);
+    } else _failed |= std::exchange(_ahead, 0u);
+  }
+
+  return AsyncBase::complete(pulse_count_majority);
+}
+
+/// Set number of channels
+///
+/// Clears failure bitmap and retry counters.
+///
+/// \param  channels  Number of channels
+void Broadcast::channels(size_t channels) {
+  assert(channels <= max_channels);
+  _channels = channels;
+  _pulse_counts = _repeats = {};
+  _retries = {};
+  _outstanding = _failed = _ahead = 0u;
+  _accepted_size = 0uz;
+}
+
+/// Get number of channels
+///
+/// \return Number of channels
+size_t Broadcast::channels() const { return _channels; }
+
+/// Get failure bitmap
+///
+/// \return Bitmap of failed channels
+uint64_t Broadcast::failed() const { return _failed; }
+
+/// Get number of retries
+///
+/// \param  channel Channel
+/// \return Number of retries of channel
+size_t Broadcast::retries(size_t channel) const {
+  assert(channel < _channels);
+  return _retries[channel];
+}
+
+/// Start transmitting bytes on all active channels
+///
+/// \param bytes    Bytes
+/// \param timeout  Response timeout [us]
+void Broadcast::transmitAsync(std::span<uint8_t const> bytes,
+                              uint32_t timeout) {
+  _bytes = bytes;
+  _timeout = timeout;
+  // Channels ahead already accepted a repeat, anything else is out of sync
+  uint64_t ahead{};
+  if (std::ranges::equal(bytes, std::span{_accepted}.first(_accepted_size)))
+    ahead = std::exchange(_ahead, 0u);
+  else _failed |= std::exchange(_ahead, 0u);
+  _accepted_size = 0uz;
+  _outstanding = active() & ~ahead;
+  for (auto i{0uz}; i < _channels; ++i)
+    if (ahead & (1ull << i)) _pulse_counts[i] = 2u;
+  // All channels failed
+  if (!_outstanding && !ahead) {
+    AsyncBase::complete(0u);
+    return;
+  }
+  // Only channels ahead left
+  if (!_outstanding) {
+    aggregate();
+    return;
+  }
+  for (auto i{0uz}; i < _channels; ++i)
+    if (_outstanding & (1ull << i)) {
+      _repeats[i] = 0u;
+      transmitChannel(i, bytes, timeout);
+    }
+}
+
+/// Reset
+///
+/// Drops transmissions in flight and clears failure bitmap and retry counters.
+void Broadcast::resetBackend() { channels(_channels); }
+
+/// Check if host repeats current transmission on a Nak
+///
+/// \retval true  ZSU block or ZPP flash packet
+/// \retval false Anything else
+bool Broadcast::repeatable() const {
+  auto const state{transmitState()};
+  return state == State::ZsuBlocks || state == State::ZppFlashWrite;
+}
+
+/// Get bitmap of active channels
+///
+/// \return Bitmap of channels which haven't failed
+uint64_t Broadcast::active() const {
+  auto const all{_channels < max_channels ? (1ull << _channels) - 1ull
+                                          : ~0ull};
+  return all & ~_failed;
+}
+
+/// Get majority pulse count of active channels
+///
+/// Only channels which answered with a single or double pulse are taken into
+/// account, ties are resolved in favor of double pulses.
+///
+/// \return Pulse count most answering channels answered with, 0 if none
+///         answered at all
+uint8_t Broadcast::majority() const {
+  size_t singles{}, doubles{};
+  for (auto i{0uz}; i < _channels; ++i)
+    if (active() & (1ull << i)) {
+      singles += _pulse_counts[i] == 1u;
+      doubles += _pulse_counts[i] == 2u;
+    }
+  if (doubles && doubles >= singles) return 2u;
+  else if (singles) return 1u;
+  else return 0u;
+}
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,119 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive replay
+///
+/// \file   rx/replay.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/replay.hpp"
+#include <algorithm>
+
+namespace ulf::decup_ein::rx {
+
+/// Replay next record
+///
+/// \retval true  Record replayed
+/// \retval false End of trace or corrupt record
+bool Replay::step() {
+  auto const record{Trace::read(_trace)};
+  if (!record) return false;
+  switch (record->type) {
+    case Trace::Type::Receive:
+      receive(static_cast<uint8_t>(record->value));
+      break;
+    case Trace::Type::ReceiveBulk:
+      _responses.resize(record->value);
+      receive(record->bytes, _responses);
+      break;
+    case Trace::Type::CompleteSync:
+      // Should have been consumed by transmitAsync
+      ++_mismatches;
+      [[fallthrough]];
+    case Trace::Type::Complete:
+      complete(static_cast<uint8_t>(record->value));
+      break;
+    case Trace::Type::Reset: reset(); break;
+    // Should have been consumed by transmitAsync or config
+    case Trace::Type::Transmit: [[fallthrough]];
+    case Trace::Type::Config: ++_mismatches; break;
+  }
+  return true;
+}
+
+/// Replay whole trace
+///
+/// \return Number of mismatches
+size_t Replay::run() {
+  while (step());
+  return _mismatches;
+}
+
+/// Get number of mismatches
+///
+/// \return Number of transmissions or configs which differ from trace
+size_t Replay::mismatches() const { return _mismatches; }
+
+/// Compare transmission against trace
+///
+/// Completes right away if the recorded backend did so.
+///
+/// \param bytes    Bytes
+/// \param timeout  Response timeout [us]
+void Replay::transmitAsync(std::span<uint8_t const> bytes, uint32_t timeout) {
+  expect(Trace::Type::Transmit, timeout, bytes);
+  if (auto const record{peek()};
+      record && record->type == Trace::Type::CompleteSync) {
+    Trace::read(_trace);
+    complete(static_cast<uint8_t>(record->value));
+  }
+}
+
+/// Compare config against trace
+///
+/// \param  stop_bits Stop bit count
+void Replay::config(uint8_t stop_bits) { configUart(stop_bits, 0u); }
+
+/// Compare config against trace
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+/// \retval true      Recorded backend applied baud rate
+/// \retval false     Recorded backend didn't apply baud rate
+bool Replay::configUart(uint8_t stop_bits, uint32_t baud_rate) {
+  auto const record{peek()};
+  expect(Trace::Type::Config, stop_bits);
+  return record && record->type == Trace::Type::Config &&
+         record->baud_rate == baud_rate;
+}
+
+/// Peek at next record
+///
+/// \retval std::optional End of trace or corrupt record
+/// \retval Record        Record
+std::optional<Trace::Record> Replay::peek() const {
+  auto trace{_trace};
+  return Trace::read(trace);
+}
+
+/// Consume next record if it's of the expected type and count mismatches
+///
+/// \param  type  Expected type
+/// \param  value Expected value
+/// \param  bytes Expected bytes
+void Replay::expect(Trace::Type type,
+                    uint32_t value,
+                    std::span<uint8_t const> bytes) {
+  auto const record{peek()};
+  if (!record || record->type != type) {
+    ++_mismatches;
+    return;
+  }
+  Trace::read(_trace);
+  if (record->value != value || !std::ranges::equal(record->bytes, bytes))
+    ++_mismatches;
+}
+
+} // namespace ulf::decup_ein::rx
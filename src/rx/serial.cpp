@@ -0,0 +1,291 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive Linux serial backend
+///
+/// \file   rx/serial.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/serial.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+namespace ulf::decup_ein::rx {
+
+namespace {
+
+// Add file descriptor to epoll instance
+bool epoll_add(int epoll, int fd) {
+  epoll_event event{.events = EPOLLIN, .data = {.fd = fd}};
+  return epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+} // namespace
+
+/// Ctor
+///
+/// \param  host    Host file descriptor
+/// \param  decoder Decoder file descriptor
+/// \param  latency Latency added to every timeout, e.g. of USB serial
+///                 adapters [us]
+Serial::Serial(int host, int decoder, uint32_t latency)
+  : _host{host}, _decoder{decoder},
+    _host_epoll{epoll_create1(EPOLL_CLOEXEC)},
+    _decoder_epoll{epoll_create1(EPOLL_CLOEXEC)},
+    _timer{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)},
+    _latency{latency} {
+  if (_host_epoll < 0 || _decoder_epoll < 0 || _timer < 0 ||
+      !epoll_add(_host_epoll, _host) || !epoll_add(_decoder_epoll, _decoder) ||
+      !epoll_add(_decoder_epoll, _timer))
+    fail();
+}
+
+/// Dtor
+Serial::~Serial() {
+  for (auto const fd : {_host_epoll, _decoder_epoll, _timer})
+    if (fd >= 0) close(fd);
+}
+
+/// Poll host
+///
+/// Read whatever the host sent, pass it into receive and write the responses
+/// back.
+///
+/// \param  timeout Timeout [ms] (or -1 to wait forever)
+/// \retval true    Success or timeout
+/// \retval false   Host closed or error, see \ref error
+bool Serial::poll(int timeout) {
+  epoll_event event{};
+  auto const n{epoll_wait(_host_epoll, &event, 1, timeout)};
+  if (n < 0) return errno == EINTR || fail();
+  else if (!n) return true;
+
+  auto const count{read(_host, data(_buffer), size(_buffer))};
+  if (count < 0) return errno == EAGAIN || errno == EINTR || fail();
+  else if (!count) {
+    if (!hungup(_host)) return true;
+    _error = 0;
+    return false;
+  }
+
+  auto bytes{std::span{_buffer}.first(static_cast<size_t>(count))};
+  while (!empty(bytes)) {
+    auto const result{receive(bytes, _responses)};
+    if (!write(_host, std::span{_responses}.first(result.out), timeout))
+      return false;
+    bytes = bytes.subspan(result.in);
+  }
+  return true;
+}
+
+/// Get error
+///
+/// \return errno of last failure (or 0 if host closed)
+int Serial::error() const { return _error; }
+
+/// Configure serial port
+///
+/// Raw mode, 8 data bits, no parity, 1 stop bit, no flow control and non
+/// blocking.
+///
+/// \param  fd        File descriptor
+/// \param  baud_rate Baud rate (or 0 to keep current one)
+/// \retval true      Success
+/// \retval false     Failure, see errno
+bool Serial::raw(int fd, uint32_t baud_rate) {
+  termios tio{};
+  if (tcgetattr(fd, &tio) < 0) return false;
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB | CRTSCTS);
+  tio.c_cc[VMIN] = 0u;
+  tio.c_cc[VTIME] = 0u;
+  if (baud_rate) {
+    auto const speed{termiosSpeed(baud_rate)};
+    if (!speed) {
+      errno = EINVAL;
+      return false;
+    }
+    cfsetspeed(&tio, *speed);
+  }
+  if (tcsetattr(fd, TCSANOW, &tio) < 0) return false;
+  auto const flags{fcntl(fd, F_GETFL)};
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/// Get termios speed of standard baud rate
+///
+/// \param  baud_rate     Baud rate
+/// \retval std::optional Baud rate isn't a standard one
+/// \retval uint32_t      Speed
+std::optional<uint32_t> Serial::termiosSpeed(uint32_t baud_rate) {
+  constexpr std::array<std::pair<uint32_t, speed_t>, 8uz> speeds{
+    {{9600u, B9600},
+     {19200u, B19200},
+     {38400u, B38400},
+     {57600u, B57600},
+     {115200u, B115200},
+     {230400u, B230400},
+     {460800u, B460800},
+     {921600u, B921600}}};
+  auto const it{std::ranges::find(speeds, baud_rate, [](auto const& speed) {
+    return speed.first;
+  })};
+  if (it == cend(speeds)) return std::nullopt;
+  return it->second;
+}
+
+/// Transmit bytes
+///
+/// The timeout starts once the last byte left the port. Every byte received
+/// from the decoder until then counts as pulse, a second pulse ends waiting
+/// early.
+///
+/// \param  bytes   Bytes
+/// \param  timeout Response timeout [us]
+/// \return Pulse count
+uint8_t Serial::transmit(std::span<uint8_t const> bytes, uint32_t timeout) {
+  // Drop stale bytes, e.g. late pulses of previous transmission
+  tcflush(_decoder, TCIFLUSH);
+  if (!write(_decoder, bytes, write_timeout) || tcdrain(_decoder) < 0) {
+    fail();
+    return 0u;
+  }
+
+  // Zero would disarm timer
+  auto const us{std::max<uint64_t>(uint64_t{timeout} + _latency, 1u)};
+  itimerspec spec{
+    .it_interval = {},
+    .it_value = {.tv_sec = static_cast<time_t>(us / 1'000'000u),
+                 .tv_nsec = static_cast<long>(us % 1'000'000u * 1000u)}};
+  if (timerfd_settime(_timer, 0, &spec, nullptr) < 0) {
+    fail();
+    return 0u;
+  }
+
+  uint8_t pulse_count{};
+  for (auto expired{false}; !expired && pulse_count < 2u;) {
+    std::array<epoll_event, 2uz> events{};
+    auto const n{epoll_wait(
+      _decoder_epoll, data(events), static_cast<int>(size(events)), -1)};
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      fail();
+      break;
+    }
+    for (auto const& event : std::span{events}.first(static_cast<size_t>(n))) {
+      if (event.data.fd == _timer) {
+        expired = true;
+        continue;
+      }
+      std::array<uint8_t, 16uz> pulses{};
+      ssize_t count{};
+      while ((count = read(_decoder, data(pulses), size(pulses))) > 0)
+        pulse_count = static_cast<uint8_t>(
+          std::min<size_t>(pulse_count + static_cast<size_t>(count), 255uz));
+    }
+  }
+
+  // Disarm timer and drop expiration
+  spec = {};
+  timerfd_settime(_timer, 0, &spec, nullptr);
+  uint64_t expirations{};
+  [[maybe_unused]] auto const count{
+    read(_timer, &expirations, sizeof(expirations))};
+  return pulse_count;
+}
+
+/// Check whether file descriptor hung up
+///
+/// Raw terminals return 0 from read when empty, so reading 0 bytes only
+/// means end of file if the other end hung up.
+///
+/// \param  fd    File descriptor
+/// \retval true  Hung up or invalid
+/// \retval false Still open
+bool Serial::hungup(int fd) {
+  pollfd pfd{.fd = fd, .events = POLLRDHUP, .revents = 0};
+  return ::poll(&pfd, 1u, 0) > 0 &&
+         pfd.revents & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL);
+}
+
+/// Config
+///
+/// \param  stop_bits Stop bit count
+void Serial::config(uint8_t stop_bits) { configUart(stop_bits, 0u); }
+
+/// Config UART
+///
+/// Parameters get changed once pending output got transmitted. The baud rate
+/// in use before switching counts as DECUP default and gets restored by
+/// passing 0.
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+/// \retval true      Baud rate applied
+/// \retval false     Baud rate unsupported or failure, see \ref error
+bool Serial::configUart(uint8_t stop_bits, uint32_t baud_rate) {
+  termios tio{};
+  if (tcgetattr(_decoder, &tio) < 0) return fail();
+  auto const speed{termiosSpeed(baud_rate)};
+  if (baud_rate && !speed) return false;
+  if (speed) {
+    if (!_default_speed) _default_speed = cfgetospeed(&tio);
+    cfsetspeed(&tio, *speed);
+  } else if (_default_speed) {
+    cfsetspeed(&tio, *_default_speed);
+    _default_speed.reset();
+  }
+  if (stop_bits == 2u) tio.c_cflag |= CSTOPB;
+  else tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB);
+  return tcsetattr(_decoder, TCSADRAIN, &tio) == 0 || fail();
+}
+
+/// Write all bytes to non-blocking file descriptor
+///
+/// \param  fd      File descriptor
+/// \param  bytes   Bytes
+/// \param  timeout Timeout [ms] (or -1 to wait forever)
+/// \retval true    Success
+/// \retval false   Failure or timeout, see \ref error
+bool Serial::write(int fd, std::span<uint8_t const> bytes, int timeout) {
+  using namespace std::chrono;
+  auto const deadline{steady_clock::now() + milliseconds{timeout}};
+  while (!empty(bytes)) {
+    auto const count{::write(fd, data(bytes), size(bytes))};
+    if (count >= 0) bytes = bytes.subspan(static_cast<size_t>(count));
+    else if (errno == EAGAIN) {
+      auto const remaining{
+        timeout < 0 ? -1
+                    : static_cast<int>(
+                        ceil<milliseconds>(deadline - steady_clock::now())
+                          .count())};
+      if (timeout >= 0 && remaining <= 0) {
+        errno = ETIMEDOUT;
+        return fail();
+      }
+      pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+      ::poll(&pfd, 1u, remaining);
+    } else if (errno != EINTR) return fail();
+  }
+  return true;
+}
+
+/// Store errno
+///
+/// \return false
+bool Serial::fail() {
+  _error = errno;
+  return false;
+}
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,422 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Receive Linux multi-session server
+///
+/// \file   rx/server.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/server.hpp"
+#include "rx/serial.hpp"
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+namespace ulf::decup_ein::rx {
+
+namespace {
+
+// Maximum number of events per epoll_wait
+constexpr size_t max_events{16uz};
+
+// Write all bytes to non-blocking file descriptor, waiting at most timeout
+// [ms] each time it isn't ready
+bool write_all(int fd, std::span<uint8_t const> bytes, int timeout) {
+  while (!empty(bytes)) {
+    auto const count{write(fd, data(bytes), size(bytes))};
+    if (count >= 0) bytes = bytes.subspan(static_cast<size_t>(count));
+    else if (errno == EAGAIN) {
+      pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+      if (poll(&pfd, 1u, timeout) == 0) return false;
+    } else if (errno != EINTR) return false;
+  }
+  return true;
+}
+
+// Arm (or with 0 disarm) timer
+void arm(int timer, uint64_t us) {
+  itimerspec const spec{
+    .it_interval = {},
+    .it_value = {.tv_sec = static_cast<time_t>(us / 1'000'000u),
+                 .tv_nsec = static_cast<long>(us % 1'000'000u * 1000u)}};
+  timerfd_settime(timer, 0, &spec, nullptr);
+}
+
+} // namespace
+
+/// Ctor
+///
+/// \param  port  Port
+Server::Session::Session(Port port)
+  : _host{port.host}, _decoder{port.decoder},
+    _timer{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)},
+    _baud_rate{port.baud_rate}, _default_baud_rate{port.baud_rate},
+    _latency{port.latency} {
+  if (_timer < 0) _closed = true;
+}
+
+/// Reopen closed session on another port
+///
+/// Everything set on the previous session (options, metrics, ...) gets
+/// dropped.
+///
+/// \param  port  Port
+void Server::Session::open(Port port) {
+  trace(nullptr);
+  metrics(nullptr);
+  timeouts(nullptr);
+  options({});
+  arm(_timer, 0u);
+  uint64_t expirations{};
+  [[maybe_unused]] auto const count{
+    read(_timer, &expirations, sizeof(expirations))};
+  _pulse_count = 0u;
+  _output_size = 0u;
+  _stop_bits = 1u;
+  _begin = _end = 0u;
+  _host = port.host;
+  _decoder = port.decoder;
+  _baud_rate = _default_baud_rate = port.baud_rate;
+  _latency = port.latency;
+  _default_speed.reset();
+  reset();
+  _closed = false;
+}
+
+/// Dtor
+Server::Session::~Session() {
+  if (_timer >= 0) close(_timer);
+}
+
+/// Session closed
+///
+/// \retval true  Host hung up or error
+/// \retval false Session open
+bool Server::Session::closed() const { return _closed; }
+
+/// Start transmitting bytes
+///
+/// Writes bytes to the decoder port and parks the session until either two
+/// pulses arrived or the timer expired. The timeout includes the time the
+/// bytes take on the wire.
+///
+/// \param bytes    Bytes
+/// \param timeout  Response timeout [us]
+void Server::Session::transmitAsync(std::span<uint8_t const> bytes,
+                                    uint32_t timeout) {
+  // Drop stale bytes, e.g. late pulses of previous transmission
+  tcflush(_decoder, TCIFLUSH);
+  _pulse_count = 0u;
+  if (!write_all(_decoder, bytes, Serial::write_timeout)) {
+    complete(0u);
+    return;
+  }
+  auto const wire_time{
+    _baud_rate ? size(bytes) * (1uz + CHAR_BIT + _stop_bits) * 1'000'000uz /
+                   _baud_rate
+               : 0uz};
+  // Zero would disarm timer
+  arm(_timer, std::max<uint64_t>(uint64_t{timeout} + _latency + wire_time, 1u));
+}
+
+/// Config
+///
+/// \param  stop_bits Stop bit count
+void Server::Session::config(uint8_t stop_bits) { configUart(stop_bits, 0u); }
+
+/// Config UART
+///
+/// Works like Serial::configUart, the wire time follows the baud rate.
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+/// \retval true      Baud rate applied
+/// \retval false     Baud rate unsupported or failure
+bool Server::Session::configUart(uint8_t stop_bits, uint32_t baud_rate) {
+  termios tio{};
+  if (tcgetattr(_decoder, &tio) < 0) return false;
+  auto const speed{Serial::termiosSpeed(baud_rate)};
+  if (baud_rate && !speed) return false;
+  if (speed) {
+    if (!_default_speed) _default_speed = cfgetospeed(&tio);
+    cfsetspeed(&tio, *speed);
+  } else if (_default_speed) {
+    cfsetspeed(&tio, *_default_speed);
+    _default_speed.reset();
+  }
+  if (stop_bits == 2u) tio.c_cflag |= CSTOPB;
+  else tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB);
+  if (tcsetattr(_decoder, TCSADRAIN, &tio) < 0) return false;
+  _stop_bits = stop_bits;
+  _baud_rate = baud_rate ? baud_rate : _default_baud_rate;
+  return true;
+}
+
+/// Run session until it's parked or out of host data
+///
+/// \retval true  Session open
+/// \retval false Host hung up or error
+bool Server::Session::run() {
+  if (pending()) pulses();
+  return host();
+}
+
+/// Count pulses and complete pending transmission
+void Server::Session::pulses() {
+  std::array<uint8_t, 16uz> bytes{};
+  ssize_t count{};
+  while ((count = read(_decoder, data(bytes), size(bytes))) > 0)
+    _pulse_count = static_cast<uint8_t>(
+      std::min<size_t>(_pulse_count + static_cast<size_t>(count), 255uz));
+  uint64_t expirations{};
+  auto const expired{read(_timer, &expirations, sizeof(expirations)) ==
+                     sizeof(expirations)};
+  if (_pulse_count < 2u && !expired) return;
+  arm(_timer, 0u);
+  if (auto const response{complete(_pulse_count)})
+    _output[_output_size++] = *response;
+  // Nak of rejected pipelined ZSU block
+  if (auto const response{pendingResponse()})
+    _output[_output_size++] = *response;
+}
+
+/// Write as many buffered responses to host as it takes
+///
+/// \retval true  Success, responses remain buffered while host isn't ready
+/// \retval false Error
+bool Server::Session::flush() {
+  while (_output_size) {
+    auto const count{write(_host, data(_output), _output_size)};
+    if (count > 0) {
+      _output_size = static_cast<uint8_t>(_output_size - count);
+      std::memmove(data(_output), data(_output) + count, _output_size);
+    } else if (count < 0 && errno == EAGAIN) return true;
+    else if (count < 0 && errno != EINTR) return false;
+  }
+  return true;
+}
+
+/// Read host data and pass it into receive
+///
+/// Bytes might still be referenced by a pending transmission, so the buffer
+/// only gets compacted while none is pending. Nothing gets read while
+/// responses are still buffered, the session waits for the host instead.
+///
+/// \retval true  Session open
+/// \retval false Host hung up or error
+bool Server::Session::host() {
+  for (;;) {
+    if (!flush()) return false;
+    else if (_output_size) return true;
+    if (!pending() && _begin) {
+      std::memmove(data(_buffer), data(_buffer) + _begin, _end - _begin);
+      _end = static_cast<uint16_t>(_end - _begin);
+      _begin = 0u;
+    }
+    if (_end < size(_buffer)) {
+      auto const count{read(_host, data(_buffer) + _end, size(_buffer) - _end)};
+      if (count > 0) _end = static_cast<uint16_t>(_end + count);
+      else if (!count ? Serial::hungup(_host)
+                      : errno != EAGAIN && errno != EINTR)
+        return false;
+    }
+    if (_begin == _end) return true;
+    auto const result{
+      receive(std::span{_buffer}.subspan(_begin, _end - _begin),
+              std::span{_output}.first(response_size))};
+    _output_size = static_cast<uint8_t>(result.out);
+    _begin = static_cast<uint16_t>(_begin + result.in);
+    // Parked
+    if (!result.in && !result.out) return true;
+  }
+}
+
+/// Ctor
+///
+/// \param  workers Number of worker threads
+Server::Server(size_t workers)
+  : _queues(std::max(workers, 1uz)), _epoll{epoll_create1(EPOLL_CLOEXEC)},
+    _event{eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC)} {
+  // Level-triggered, so that stopping wakes all workers
+  epoll_event event{.events = EPOLLIN, .data = {.ptr = nullptr}};
+  epoll_ctl(_epoll, EPOLL_CTL_ADD, _event, &event);
+  for (auto i{0uz}; i < size(_queues); ++i)
+    _workers.emplace_back([this, i] { work(i); });
+}
+
+/// Dtor
+Server::~Server() {
+  _stopping = true;
+  uint64_t const one{1u};
+  [[maybe_unused]] auto const count{write(_event, &one, sizeof(one))};
+  _workers.clear();
+  close(_event);
+  close(_epoll);
+}
+
+/// Add session
+///
+/// Slots of closed sessions get reused, so a pointer to a closed session may
+/// refer to a new one after calling this.
+///
+/// \param  port    Port
+/// \retval nullptr Failure
+/// \retval Session Session
+Server::Session* Server::add(Port port) {
+  std::scoped_lock lock{_mutex};
+  auto const it{std::ranges::find_if(_sessions, [](Session const& session) {
+    return session._schedule == Session::Closed && session._timer >= 0;
+  })};
+  auto& session{it != end(_sessions) ? *it : _sessions.emplace_back(port)};
+  // Stale events of the previous session at most cause a spurious run
+  if (it != end(_sessions)) {
+    session.open(port);
+    session._schedule = Session::Idle;
+  } else if (session.closed()) return nullptr;
+  for (auto const fd : {session._host, session._decoder, session._timer}) {
+    // Host also wakes session once it's ready to take buffered responses
+    epoll_event event{.events = EPOLLIN | EPOLLET |
+                                (fd == session._host ? EPOLLOUT : 0u),
+                      .data = {.ptr = &session}};
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+      for (auto const added : {session._host, session._decoder, session._timer})
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, added, nullptr);
+      session._closed = true;
+      session._schedule = Session::Closed;
+      return nullptr;
+    }
+  }
+  ++_open;
+  return &session;
+}
+
+/// Number of open sessions
+///
+/// \return Number of open sessions
+size_t Server::sessions() const { return _open; }
+
+/// Number of sessions stolen by idle workers
+///
+/// \return Number of steals
+size_t Server::steals() const { return _steals; }
+
+/// Worker
+///
+/// \param  worker  Index of worker
+void Server::work(size_t worker) {
+  while (!_stopping) {
+    if (auto const session{pop(worker)}) {
+      execute(session);
+      continue;
+    }
+    std::array<epoll_event, max_events> events{};
+    auto const n{epoll_wait(
+      _epoll, data(events), static_cast<int>(size(events)), -1)};
+    for (auto const& event : std::span{events}.first(
+           static_cast<size_t>(std::max(n, 0)))) {
+      // Stop or hint to steal
+      if (!event.data.ptr) {
+        if (_stopping) return;
+        uint64_t value{};
+        [[maybe_unused]] auto const count{
+          read(_event, &value, sizeof(value))};
+      } else notify(worker, static_cast<Session*>(event.data.ptr));
+    }
+  }
+}
+
+/// Execute session
+///
+/// Events arriving while the session runs make it run once more. Closing is
+/// the last access to a session, afterwards its slot might get reused.
+///
+/// \param  session Session
+void Server::execute(Session* session) {
+  uint8_t queued{Session::Queued};
+  if (!session->_schedule.compare_exchange_strong(queued, Session::Running))
+    return;
+  for (;;) {
+    if (!session->run()) {
+      for (auto const fd : {session->_host, session->_decoder, session->_timer})
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+      session->_closed = true;
+      --_open;
+      session->_schedule = Session::Closed;
+      return;
+    }
+    uint8_t expected{Session::Running};
+    if (session->_schedule.compare_exchange_strong(expected, Session::Idle))
+      return;
+    session->_schedule = Session::Running;
+  }
+}
+
+/// Notify session about event
+///
+/// Idle sessions get queued on worker, running ones run once more.
+///
+/// \param  worker  Index of worker
+/// \param  session Session
+void Server::notify(size_t worker, Session* session) {
+  auto schedule{session->_schedule.load()};
+  for (;;) {
+    if (schedule == Session::Idle) {
+      if (!session->_schedule.compare_exchange_weak(schedule,
+                                                    Session::Queued))
+        continue;
+      auto& queue{_queues[worker]};
+      std::scoped_lock lock{queue.mutex};
+      queue.sessions.push_back(session);
+      // Let idle workers steal
+      if (size(queue.sessions) > 1uz) {
+        uint64_t const one{1u};
+        [[maybe_unused]] auto const count{write(_event, &one, sizeof(one))};
+      }
+      return;
+    } else if (schedule == Session::Running) {
+      if (session->_schedule.compare_exchange_weak(schedule, Session::Again))
+        return;
+    }
+    // Already queued, running again or closed
+    else return;
+  }
+}
+
+/// Pop session from own queue or steal one from another worker
+///
+/// \param  worker  Index of worker
+/// \retval nullptr No session ready
+/// \retval Session Session
+Server::Session* Server::pop(size_t worker) {
+  {
+    auto& queue{_queues[worker]};
+    std::scoped_lock lock{queue.mutex};
+    if (!empty(queue.sessions)) {
+      auto const session{queue.sessions.back()};
+      queue.sessions.pop_back();
+      return session;
+    }
+  }
+  for (auto i{1uz}; i < size(_queues); ++i) {
+    auto& queue{_queues[(worker + i) % size(_queues)]};
+    std::scoped_lock lock{queue.mutex};
+    if (!empty(queue.sessions)) {
+      auto const session{queue.sessions.front()};
+      queue.sessions.pop_front();
+      ++_steals;
+      return session;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace ulf::decup_ein::rx
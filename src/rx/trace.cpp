@@ -0,0 +1,195 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Session trace
+///
+/// \file   rx/trace.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "rx/trace.hpp"
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+namespace ulf::decup_ein::rx {
+
+namespace {
+
+// Maximum size of LEB128 encoded 32 bit number
+constexpr size_t max_leb128_size{(sizeof(uint32_t) * CHAR_BIT + 6uz) / 7uz};
+
+// Read LEB128 encoded number
+std::optional<uint32_t> read_leb128(std::span<uint8_t const>& trace) {
+  uint32_t retval{};
+  for (auto i{0uz}; i < size(trace) && i < max_leb128_size; ++i) {
+    retval |= static_cast<uint32_t>(trace[i] & 0x7Fu) << (7uz * i);
+    if (!(trace[i] & 0x80u)) {
+      trace = trace.subspan(i + 1uz);
+      return retval;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+/// Record received byte
+///
+/// \param  byte  Byte
+void Trace::receive(uint8_t byte) {
+  if (!header(Type::Receive, 1uz)) return;
+  _buffer[_size++] = byte;
+}
+
+/// Record received bytes
+///
+/// Every consumed byte produces at most one response, plus a queued one of a
+/// rejected pipelined ZSU block. Capacity beyond that makes no difference and
+/// gets clamped.
+///
+/// \param  bytes     Bytes
+/// \param  responses Response capacity
+void Trace::receive(std::span<uint8_t const> bytes, size_t responses) {
+  if (!header(Type::ReceiveBulk, 2uz * max_leb128_size + size(bytes))) return;
+  write(static_cast<uint32_t>(std::min(responses, size(bytes) + 1uz)));
+  write(bytes);
+}
+
+/// Record transmitted bytes
+///
+/// \param  bytes   Bytes
+/// \param  timeout DECUP response timeout [us]
+void Trace::transmit(std::span<uint8_t const> bytes, uint32_t timeout) {
+  if (!header(Type::Transmit, 2uz * max_leb128_size + size(bytes))) return;
+  write(timeout);
+  write(bytes);
+}
+
+/// Record completion
+///
+/// \param  pulse_count Pulse count
+/// \param  synchronous Completed from within transmitAsync
+void Trace::complete(uint8_t pulse_count, bool synchronous) {
+  if (!header(synchronous ? Type::CompleteSync : Type::Complete, 1uz)) return;
+  _buffer[_size++] = pulse_count;
+}
+
+/// Record config
+///
+/// \param  stop_bits Stop bit count
+/// \param  baud_rate Baud rate (or 0 for DECUP default)
+void Trace::config(uint8_t stop_bits, uint32_t baud_rate) {
+  if (!header(Type::Config, 1uz + max_leb128_size)) return;
+  _buffer[_size++] = stop_bits;
+  write(baud_rate);
+}
+
+/// Record reset
+void Trace::reset() { header(Type::Reset, 0uz); }
+
+/// Get recorded data
+///
+/// \return Recorded data
+std::span<uint8_t const> Trace::data() const {
+  return std::span{_buffer}.first(_size);
+}
+
+/// Get overflow
+///
+/// \retval true  Buffer ran full, trace is incomplete
+/// \retval false Trace is complete
+bool Trace::overflow() const { return _overflow; }
+
+/// Clear recorded data
+void Trace::clear() {
+  _size = 0uz;
+  _overflow = false;
+}
+
+/// Read next record
+///
+/// \param  trace         Trace, advanced past the record on success
+/// \retval std::optional End of trace or corrupt record
+/// \retval Record        Record
+std::optional<Trace::Record> Trace::read(std::span<uint8_t const>& trace) {
+  if (empty(trace) || trace[0uz] > std::to_underlying(Type::Reset))
+    return std::nullopt;
+  auto bytes{trace.subspan(1uz)};
+  Record retval{.type = static_cast<Type>(trace[0uz])};
+  auto const time{read_leb128(bytes)};
+  if (!time) return std::nullopt;
+  retval.time = *time;
+  switch (retval.type) {
+    case Type::Receive: [[fallthrough]];
+    case Type::Complete: [[fallthrough]];
+    case Type::CompleteSync:
+      if (empty(bytes)) return std::nullopt;
+      retval.value = bytes[0uz];
+      bytes = bytes.subspan(1uz);
+      break;
+    case Type::Config: {
+      if (empty(bytes)) return std::nullopt;
+      retval.value = bytes[0uz];
+      bytes = bytes.subspan(1uz);
+      auto const baud_rate{read_leb128(bytes)};
+      if (!baud_rate) return std::nullopt;
+      retval.baud_rate = *baud_rate;
+      break;
+    }
+    case Type::ReceiveBulk: [[fallthrough]];
+    case Type::Transmit: {
+      auto const value{read_leb128(bytes)};
+      auto const count{read_leb128(bytes)};
+      if (!value || !count || *count > size(bytes)) return std::nullopt;
+      retval.value = *value;
+      retval.bytes = bytes.first(*count);
+      bytes = bytes.subspan(*count);
+      break;
+    }
+    case Type::Reset: break;
+  }
+  trace = bytes;
+  return retval;
+}
+
+/// Write record header
+///
+/// \param  type          Type
+/// \param  payload_size  Maximum size of payload
+/// \retval true          Header written, payload fits
+/// \retval false         Overflow
+bool Trace::header(Type type, size_t payload_size) {
+  if (_overflow ||
+      size(_buffer) - _size < 1uz + max_leb128_size + payload_size) {
+    _overflow = true;
+    return false;
+  }
+  auto const now{clock ? clock() : 0u};
+  _buffer[_size++] = std::to_underlying(type);
+  write(now - std::exchange(_time, now));
+  return true;
+}
+
+/// Write LEB128 encoded number
+///
+/// \param  value Value
+void Trace::write(uint32_t value) {
+  while (value >= 0x80u) {
+    _buffer[_size++] = static_cast<uint8_t>(value | 0x80u);
+    value >>= 7u;
+  }
+  _buffer[_size++] = static_cast<uint8_t>(value);
+}
+
+/// Write size and bytes
+///
+/// \param  bytes Bytes
+void Trace::write(std::span<uint8_t const> bytes) {
+  write(static_cast<uint32_t>(size(bytes)));
+  std::ranges::copy(bytes, begin(_buffer) + static_cast<ptrdiff_t>(_size));
+  _size += size(bytes);
+}
+
+} // namespace ulf::decup_ein::rx
@@ -0,0 +1,127 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Transmit ZPP session
+///
+/// \file   tx/zpp_session.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "tx/zpp_session.hpp"
+#include <algorithm>
+#include <decup/decup.hpp>
+#include "ack.hpp"
+#include "checksum.hpp"
+
+namespace ulf::decup_ein::tx {
+
+namespace {
+
+// Flash packet payload size
+constexpr size_t packet_size{256uz};
+
+// Padding of last packet
+constexpr auto padding{[] {
+  std::array<uint8_t, packet_size> retval{};
+  retval.fill(0xFFu);
+  return retval;
+}()};
+
+} // namespace
+
+/// Ctor
+///
+/// \param  flash           Flash image
+/// \param  preamble_count  Number of preamble bytes
+/// \param  max_retries     Maximum number of retries per transfer
+ZppSession::ZppSession(std::span<uint8_t const> flash,
+                       size_t preamble_count,
+                       uint8_t max_retries)
+  : _flash{flash}, _preamble_count{preamble_count}, _max_retries{max_retries} {
+  if (!_preamble_count) _state = State::FlashErase;
+}
+
+/// Next transfer
+///
+/// \return Spans of next transfer (empty once done or failed)
+Spans ZppSession::next() {
+  switch (_state) {
+    case State::Preamble:
+      _header[0uz] = std::to_underlying(_index % 3uz == 2uz
+                                          ? decup::Command::Preamble1
+                                          : decup::Command::Preamble0);
+      return {std::span{_header}.first(1uz)};
+    case State::FlashErase:
+      _header = {std::to_underlying(decup::Command::DeleteFlash),
+                 0x55u,
+                 0xFFu,
+                 0xFFu};
+      return {std::span{_header}};
+    case State::FlashWrite: {
+      auto const offset{_index * packet_size};
+      auto const payload{
+        _flash.subspan(offset, std::min(packet_size, size(_flash) - offset))};
+      auto const pad{std::span{padding}.first(packet_size - size(payload))};
+      _header = {std::to_underlying(decup::Command::WriteFlash),
+                 0x55u,
+                 static_cast<uint8_t>(_index >> 0u),
+                 static_cast<uint8_t>(_index >> 8u)};
+      _trailer = Crc8{0x55u}.update(payload).update(pad).value();
+      return {std::span{_header}, payload, pad, std::span{&_trailer, 1uz}};
+    }
+    default: return {};
+  }
+}
+
+/// Response of last transfer
+///
+/// \param  response Response
+void ZppSession::response(std::optional<uint8_t> response) {
+  switch (_state) {
+    case State::Preamble:
+      if (++_index < _preamble_count) break;
+      _index = 0uz;
+      _state = State::FlashErase;
+      break;
+    case State::FlashErase:
+      if (response != ack) retry();
+      else {
+        _retries = 0u;
+        _state = progress().total ? State::FlashWrite : State::Done;
+      }
+      break;
+    case State::FlashWrite:
+      if (response != ack) retry();
+      else {
+        _retries = 0u;
+        if (++_index >= progress().total) _state = State::Done;
+      }
+      break;
+    default: break;
+  }
+}
+
+/// Get state
+///
+/// \return State
+ZppSession::State ZppSession::state() const { return _state; }
+
+/// Get progress
+///
+/// \return Acknowledged and total packets
+Progress ZppSession::progress() const {
+  auto const total{(size(_flash) + packet_size - 1uz) / packet_size};
+  switch (_state) {
+    case State::FlashWrite: return {_index, total};
+    case State::Done: return {total, total};
+    default: return {0uz, total};
+  }
+}
+
+/// Retry last transfer or fail
+void ZppSession::retry() {
+  if (++_retries > _max_retries) _state = State::Failed;
+}
+
+} // namespace ulf::decup_ein::tx
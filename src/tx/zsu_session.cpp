@@ -0,0 +1,171 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Transmit ZSU session
+///
+/// \file   tx/zsu_session.cpp
+/// \author Vincent Hamp
+/// \date   17/10/2026
+
+#include "tx/zsu_session.hpp"
+#include <algorithm>
+#include <decup/decup.hpp>
+#include "ack.hpp"
+#include "checksum.hpp"
+#include "nak.hpp"
+
+namespace ulf::decup_ein::tx {
+
+namespace {
+
+// Padding of last block
+constexpr auto padding{[] {
+  std::array<uint8_t, 64uz> retval{};
+  retval.fill(0xFFu);
+  return retval;
+}()};
+
+} // namespace
+
+/// Ctor
+///
+/// \param  firmwares       Firmwares to probe decoder IDs of
+/// \param  preamble_count  Number of preamble bytes
+/// \param  max_retries     Maximum number of retries per transfer
+ZsuSession::ZsuSession(std::span<Firmware const> firmwares,
+                       size_t preamble_count,
+                       uint8_t max_retries)
+  : _firmwares{firmwares}, _preamble_count{preamble_count},
+    _max_retries{max_retries} {
+  if (!_preamble_count) _state = State::DecoderId;
+  if (empty(_firmwares)) _state = State::Failed;
+}
+
+/// Resume at block
+///
+/// \param  decoder_id  Acknowledged decoder ID
+/// \param  block       Index of first unacknowledged block
+/// \retval true        Resumed
+/// \retval false       No firmware with decoder ID or block out of range
+bool ZsuSession::resume(uint8_t decoder_id, size_t block) {
+  auto const it{std::ranges::find(_firmwares, decoder_id, &Firmware::id)};
+  if (it == cend(_firmwares)) return false;
+  _firmware = *it;
+  _block_size = decup::decoder_id2block_size(_firmware.id);
+  if (block >= progress().total) {
+    _block_size = 0uz;
+    return false;
+  }
+  _index = block;
+  _retries = 0u;
+  _state = State::Blocks;
+  return true;
+}
+
+/// Next transfer
+///
+/// \return Spans of next transfer (empty once done or failed)
+Spans ZsuSession::next() {
+  switch (_state) {
+    case State::Preamble:
+      _header = std::to_underlying(_index % 2uz ? decup::Command::Preamble1
+                                                : decup::Command::Preamble0);
+      break;
+    case State::DecoderId: _header = _firmwares[_index].id; break;
+    case State::BlockCount:
+      _header = static_cast<uint8_t>(size(_firmware.bin) / 256uz + 8uz - 1uz);
+      break;
+    case State::SecurityByte1: _header = 0x55u; break;
+    case State::SecurityByte2: _header = 0xAAu; break;
+    case State::Blocks: {
+      auto const offset{_index * _block_size};
+      auto const payload{_firmware.bin.subspan(
+        offset, std::min(_block_size, size(_firmware.bin) - offset))};
+      auto const pad{std::span{padding}.first(_block_size - size(payload))};
+      _header = static_cast<uint8_t>(_index);
+      _trailer = static_cast<uint8_t>(_header ^ exor(payload) ^
+                                      (size(pad) % 2uz ? 0xFFu : 0x00u));
+      return {
+        std::span{&_header, 1uz}, payload, pad, std::span{&_trailer, 1uz}};
+    }
+    default: return {};
+  }
+  return {std::span{&_header, 1uz}};
+}
+
+/// Response of last transfer
+///
+/// \param  response Response
+void ZsuSession::response(std::optional<uint8_t> response) {
+  switch (_state) {
+    case State::Preamble:
+      if (++_index < _preamble_count) break;
+      _index = 0uz;
+      _state = State::DecoderId;
+      break;
+    case State::DecoderId:
+      if (response == ack) {
+        _firmware = _firmwares[_index];
+        _block_size = decup::decoder_id2block_size(_firmware.id);
+        _index = 0uz;
+        _state = State::BlockCount;
+      } else if (++_index >= size(_firmwares)) _state = State::Failed;
+      break;
+    case State::BlockCount: advance(response == nak); break;
+    case State::SecurityByte1: advance(response == nak); break;
+    case State::SecurityByte2: advance(response == nak); break;
+    case State::Blocks:
+      if (response != ack) retry();
+      else {
+        _retries = 0u;
+        if (++_index >= progress().total) _state = State::Done;
+      }
+      break;
+    default: break;
+  }
+}
+
+/// Get state
+///
+/// \return State
+ZsuSession::State ZsuSession::state() const { return _state; }
+
+/// Get progress
+///
+/// \return Acknowledged and total blocks
+Progress ZsuSession::progress() const {
+  auto const total{_block_size ? (size(_firmware.bin) + _block_size - 1uz) /
+                                   _block_size
+                               : 0uz};
+  switch (_state) {
+    case State::Blocks: return {_index, total};
+    case State::Done: return {total, total};
+    default: return {0uz, total};
+  }
+}
+
+/// Get firmware whose decoder ID got acknowledged
+///
+/// \retval std::optional No decoder ID acknowledged (yet)
+/// \retval Firmware      Firmware
+std::optional<Firmware> ZsuSession::firmware() const {
+  if (!_block_size) return std::nullopt;
+  return _firmware;
+}
+
+/// Advance to next state or retry
+///
+/// \param  success Last transfer successful
+void ZsuSession::advance(bool success) {
+  if (!success) return retry();
+  _retries = 0u;
+  _state = static_cast<State>(std::to_underlying(_state) + 1u);
+}
+
+/// Retry last transfer or fail
+void ZsuSession::retry() {
+  if (++_retries > _max_retries) _state = State::Failed;
+}
+
+} // namespace ulf::decup_ein::tx
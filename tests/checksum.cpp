@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <ulf/decup_ein.hpp>
+#include <zpp/zpp.hpp>
+#include <zsu/zsu.hpp>
+#include "utility.hpp"
+
+using ulf::decup_ein::Crc8;
+using ulf::decup_ein::Exor;
+
+namespace {
+
+// Odd lengths and offsets to hit every tail of the sliced loops
+void expect_equivalent(std::span<uint8_t const> bytes) {
+  for (auto const len : {0uz, 1uz, 3uz, 4uz, 7uz, 8uz, 63uz, 256uz, 257uz})
+    for (auto const offset : {0uz, 1uz, 5uz}) {
+      if (offset + len > size(bytes)) continue;
+      auto const chunk{bytes.subspan(offset, len)};
+      EXPECT_EQ(ulf::decup_ein::crc8(chunk, 0x55u), decup::crc8(chunk, 0x55u));
+      EXPECT_EQ(ulf::decup_ein::crc8(chunk, 0xAAu), decup::crc8(chunk, 0xAAu));
+      EXPECT_EQ(ulf::decup_ein::exor(chunk), decup::exor(chunk));
+    }
+}
+
+} // namespace
+
+TEST(checksum, equivalent_to_decup_zsu) {
+  auto const zsu_file{
+    zsu::read(source_location_parent_path() / "../data/DS240307.zsu")};
+  for (auto const& fw : zsu_file.firmwares) expect_equivalent(fw.bin);
+}
+
+TEST(checksum, equivalent_to_decup_zpp) {
+  auto const zpp_file{
+    zpp::read(source_location_parent_path() / "../data/test.zpp")};
+  expect_equivalent(zpp_file.flash);
+}
+
+TEST(checksum, incremental) {
+  auto const zpp_file{
+    zpp::read(source_location_parent_path() / "../data/test.zpp")};
+  std::span<uint8_t const> flash{zpp_file.flash};
+  flash = flash.first(std::min(size(flash), 4096uz));
+
+  // Feed in uneven pieces as they would arrive from a transport
+  Crc8 crc{0x55u};
+  Exor exor{};
+  for (auto bytes{flash}; !empty(bytes);) {
+    auto const piece{bytes.first(std::min(size(bytes), 13uz))};
+    crc.update(piece.front()).update(piece.subspan(1uz));
+    exor.update(piece);
+    bytes = bytes.subspan(size(piece));
+  }
+  EXPECT_EQ(crc.value(), decup::crc8(flash, 0x55u));
+  EXPECT_EQ(exor.value(), decup::exor(flash));
+}
+
+TEST(checksum, erased) {
+  std::vector<uint8_t> bytes(5uz + 256uz, 0xFFu);
+  for (auto const offset : {0uz, 1uz, 5uz})
+    for (auto const len : {0uz, 1uz, 7uz, 8uz, 9uz, 256uz}) {
+      auto const chunk{std::span{bytes}.subspan(offset, len)};
+      EXPECT_TRUE(ulf::decup_ein::erased(chunk));
+      // Any cleared bit, either in a word or in the tail
+      for (auto i{0uz}; i < len; ++i) {
+        chunk[i] = 0x7Fu;
+        EXPECT_FALSE(ulf::decup_ein::erased(chunk));
+        chunk[i] = 0xFFu;
+      }
+    }
+}
+
+TEST(checksum, constexpr_evaluation) {
+  static constexpr std::array<uint8_t, 11uz> bytes{
+    0x00u, 0x01u, 0x02u, 0x03u, 0x04u, 0x05u,
+    0x06u, 0x07u, 0x08u, 0x09u, 0x0Au};
+  static constexpr auto crc{ulf::decup_ein::crc8(bytes, 0x55u)};
+  static constexpr auto exor{ulf::decup_ein::exor(bytes)};
+  static_assert(!ulf::decup_ein::erased(bytes));
+  static_assert(ulf::decup_ein::erased(std::array<uint8_t, 9uz>{
+    0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu}));
+  EXPECT_EQ(crc, decup::crc8(bytes, 0x55u));
+  EXPECT_EQ(exor, decup::exor(bytes));
+}
@@ -0,0 +1,49 @@
+#include <array>
+#include "../rx/rx_mock.hpp"
+
+using namespace testing;
+using namespace ulf::decup_ein::rx;
+
+static_assert(zpp_enabled && !zsu_enabled && cvset_enabled);
+
+TEST(ZppOnlyTest, zsu_gets_ignored) {
+  NiceMock<RxMock> mock;
+
+  EXPECT_CALL(mock, transmit(_, _)).WillOnce(Return(0u));
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+  EXPECT_EQ(mock.receive(221u), std::nullopt);
+  EXPECT_EQ(mock.checkpoint(), std::nullopt);
+  EXPECT_EQ(mock.restore({.decoder_id = 221u, .block = 0u, .block_count = 1u}),
+            ulf::decup_ein::nak);
+}
+
+TEST(ZppOnlyTest, zpp_cv_read) {
+  NiceMock<RxMock> mock;
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+
+  EXPECT_CALL(mock,
+              transmit(ElementsAre(std::to_underlying(decup::Command::CvRead),
+                                   7u,
+                                   0u),
+                       decup::Timeouts::zpp_cv_read))
+    .WillOnce(Return(2u));
+  EXPECT_CALL(mock, transmit(ElementsAre(0xFFu), decup::Timeouts::zpp_cv_read))
+    .Times(Exactly(7))
+    .WillRepeatedly(Return(1u));
+  mock.receive(std::to_underlying(decup::Command::CvRead));
+  mock.receive(7u);
+  EXPECT_EQ(mock.receive(0u), ulf::decup_ein::ack);
+  for (auto i{0uz}; i < 7uz; ++i)
+    EXPECT_EQ(mock.receive(0xFFu), ulf::decup_ein::nak);
+}
+
+TEST(ZppOnlyTest, write_cvs) {
+  NiceMock<RxMock> mock;
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+
+  std::array<AsyncBase::Cv, 1uz> const cvs{{{.address = 7u, .value = 42u}}};
+  EXPECT_CALL(mock, transmit(_, decup::Timeouts::zpp_cvset))
+    .Times(Exactly(4))
+    .WillRepeatedly(Return(2u));
+  EXPECT_EQ(mock.writeCvs(cvs), ulf::decup_ein::ack);
+}
@@ -0,0 +1,49 @@
+#include <array>
+#include "../rx/rx_mock.hpp"
+
+using namespace testing;
+using namespace ulf::decup_ein::rx;
+
+static_assert(!zpp_enabled && zsu_enabled && !cvset_enabled);
+static_assert(max_packet_size == max_zsu_block_size);
+
+TEST(ZsuOnlyTest, zpp_gets_ignored) {
+  NiceMock<RxMock> mock;
+
+  EXPECT_CALL(mock, transmit(_, _)).WillOnce(Return(0u));
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+  EXPECT_EQ(mock.receive(std::to_underlying(decup::Command::CvRead)),
+            std::nullopt);
+
+  std::array<uint16_t, 1uz> const cvs{7u};
+  std::array<uint8_t, 1uz> values{};
+  std::array<uint8_t, 1uz> errors{};
+  EXPECT_EQ(mock.readCvs(cvs, values, errors), ulf::decup_ein::nak);
+  EXPECT_EQ(mock.readCvs(7u, values, errors), ulf::decup_ein::nak);
+  std::array<AsyncBase::Cv, 1uz> const writes{{{.address = 7u, .value = 42u}}};
+  EXPECT_EQ(mock.writeCvs(writes), ulf::decup_ein::nak);
+}
+
+TEST(ZsuOnlyTest, zsu_block) {
+  NiceMock<RxMock> mock;
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+
+  EXPECT_CALL(mock,
+              transmit(ElementsAre(221u), decup::Timeouts::zsu_decoder_id))
+    .WillOnce(Return(2u));
+  EXPECT_EQ(mock.receive(221u), ulf::decup_ein::ack);
+  for (auto const byte : {100u, 0x55u, 0xAAu}) {
+    EXPECT_CALL(mock, transmit(ElementsAre(byte), _)).WillOnce(Return(1u));
+    mock.receive(static_cast<uint8_t>(byte));
+  }
+
+  // Single block, counter and XOR trailer
+  auto const block_size{decup::decoder_id2block_size(221u)};
+  EXPECT_CALL(mock,
+              transmit(SizeIs(block_size + 2uz), decup::Timeouts::zsu_blocks))
+    .WillOnce(Return(2u));
+  mock.receive(0u);
+  for (auto i{0uz}; i < block_size; ++i) mock.receive(0u);
+  EXPECT_EQ(mock.receive(0u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.checkpoint()->block, 1u);
+}
@@ -0,0 +1,152 @@
+#include <numeric>
+#include "../utility.hpp"
+#include "rx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::AdaptiveTimeouts;
+using ulf::decup_ein::rx::State;
+
+namespace {
+
+// Clock advancing 10us each call
+uint32_t clock() {
+  static uint32_t us{};
+  return us += 10u;
+}
+
+} // namespace
+
+TEST(adaptive_timeouts, percentile_plus_margin) {
+  AdaptiveTimeouts timeouts;
+  auto const max{decup::Timeouts::zsu_blocks};
+
+  // Not enough samples
+  for (auto i{0uz}; i < 15uz; ++i)
+    timeouts.record(221u, State::ZsuBlocks, max, max / 100u);
+  EXPECT_EQ(timeouts.timeout(221u, State::ZsuBlocks, max), max);
+
+  // Latency plus margin, but never more than DECUP timeout
+  timeouts.record(221u, State::ZsuBlocks, max, max / 100u);
+  auto const timeout{timeouts.timeout(221u, State::ZsuBlocks, max)};
+  EXPECT_GE(timeout, max / 100u);
+  EXPECT_LT(timeout, max / 25u);
+
+  // Other states and families are untouched
+  EXPECT_EQ(timeouts.timeout(221u, State::ZsuBlockCount, max), max);
+  EXPECT_EQ(timeouts.timeout(220u, State::ZsuBlocks, max), max);
+
+  // A single outlier is above the 99th percentile only with >100 samples
+  for (auto i{0uz}; i < 100uz; ++i)
+    timeouts.record(221u, State::ZsuBlocks, max, max / 100u);
+  timeouts.record(221u, State::ZsuBlocks, max, max);
+  EXPECT_EQ(timeouts.timeout(221u, State::ZsuBlocks, max), timeout);
+  timeouts.record(221u, State::ZsuBlocks, max, max);
+  EXPECT_EQ(timeouts.timeout(221u, State::ZsuBlocks, max), max);
+}
+
+TEST(adaptive_timeouts, clamp_percentile) {
+  AdaptiveTimeouts timeouts{200u, 50u, 1u};
+  auto const max{decup::Timeouts::zsu_blocks};
+  timeouts.record(221u, State::ZsuBlocks, max, max / 100u);
+  EXPECT_LT(timeouts.timeout(221u, State::ZsuBlocks, max), max);
+}
+
+TEST(adaptive_timeouts, evict_families) {
+  AdaptiveTimeouts timeouts{99u, 50u, 1u};
+  auto const max{decup::Timeouts::zsu_blocks};
+  for (uint8_t id{0u}; id <= AdaptiveTimeouts::max_families; ++id)
+    timeouts.record(id, State::ZsuBlocks, max, 0u);
+  EXPECT_EQ(timeouts.timeout(0u, State::ZsuBlocks, max), max);
+  for (uint8_t id{1u}; id <= AdaptiveTimeouts::max_families; ++id)
+    EXPECT_LT(timeouts.timeout(id, State::ZsuBlocks, max), max);
+}
+
+TEST_F(RxTest, adaptive_timeouts) {
+  AdaptiveTimeouts timeouts;
+  timeouts.clock = clock;
+  _mock.timeouts(&timeouts);
+
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
+    .ZsuPreamble(100uz)
+    .ZsuDecoderId(221u)
+    .ZsuBlockCount()
+    .ZsuSecurityByte1()
+    .ZsuSecurityByte2()
+    .ZsuBlocks();
+
+  // Blocks got recorded under the acknowledged decoder ID
+  auto const max{decup::Timeouts::zsu_blocks};
+  EXPECT_LT(timeouts.timeout(221u, State::ZsuBlocks, max), max);
+
+  // Persist and restore
+  std::vector<AdaptiveTimeouts::Family> const persisted{
+    cbegin(timeouts.families()), cend(timeouts.families())};
+  AdaptiveTimeouts restored;
+  restored.families(persisted);
+  EXPECT_EQ(restored.timeout(221u, State::ZsuBlocks, max),
+            timeouts.timeout(221u, State::ZsuBlocks, max));
+
+  // Next session passes adapted timeout to transmit
+  Mock::VerifyAndClearExpectations(&_mock);
+  _mock.reset();
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
+    .ZsuPreamble(100uz)
+    .ZsuDecoderId(221u)
+    .ZsuBlockCount()
+    .ZsuSecurityByte1()
+    .ZsuSecurityByte2();
+  auto const adapted{timeouts.timeout(221u, State::ZsuBlocks, max)};
+  EXPECT_CALL(_mock, transmit(_, adapted)).WillOnce(Return(2u));
+  auto const block_size{
+    decup::decoder_id2block_size(static_cast<uint8_t>(_fw.id))};
+  std::vector<uint8_t> block(block_size + 2uz);
+  block.back() = 0u;
+  for (auto const byte : block) _mock.receive(byte);
+
+  // Misses under the adapted timeout widen it again
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(0u));
+  for (auto i{0uz}; i < 10uz; ++i)
+    for (auto const byte : block) _mock.receive(byte);
+  EXPECT_EQ(timeouts.timeout(221u, State::ZsuBlocks, max), max);
+
+  // Misses under the DECUP timeout aren't recorded
+  auto const samples{[&] {
+    auto const& family{*std::ranges::find(
+      timeouts.families(), 221u, &AdaptiveTimeouts::Family::decoder_id)};
+    auto const& histogram{
+      family.histograms[std::to_underlying(State::ZsuBlocks)]};
+    return std::accumulate(cbegin(histogram), cend(histogram), 0uz);
+  }};
+  auto const before{samples()};
+  for (auto const byte : block) _mock.receive(byte);
+  EXPECT_EQ(samples(), before);
+}
+
+TEST_F(RxTest, adaptive_timeouts_decoder_id_never_adapted) {
+  AdaptiveTimeouts timeouts{99u, 50u, 1u};
+  timeouts.clock = clock;
+  _mock.timeouts(&timeouts);
+  auto const max{decup::Timeouts::zsu_decoder_id};
+
+  // Probes always use the DECUP timeout, answered or not
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(0u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(AllOf(Ge(200u), Le(221u))), Ne(max)))
+    .Times(0);
+  EXPECT_CALL(_mock, transmit(ElementsAre(221u), max))
+    .Times(Exactly(2))
+    .WillRepeatedly(Return(2u));
+  for (auto i{0uz}; i < 2uz; ++i) {
+    _mock.reset();
+    ZsuPreamble(100uz);
+    _mock.receive(221u);
+  }
+  _mock.reset();
+  ZsuPreamble(100uz);
+  for (uint8_t id{200u}; id < 220u; ++id) _mock.receive(id);
+
+  // And don't end up in the persisted families
+  for (auto const& family : timeouts.families())
+    for (auto const count :
+         family.histograms[std::to_underlying(State::ZsuDecoderId)])
+      EXPECT_EQ(count, 0u);
+}
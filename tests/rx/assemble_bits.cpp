@@ -0,0 +1,84 @@
+#include "rx_test.hpp"
+
+using namespace testing;
+
+namespace {
+
+// Answer bits of value MSB first
+auto bits(uint8_t value, size_t& bit) {
+  return [value, &bit] -> uint8_t {
+    return value & (0x80u >> bit++) ? 2u : 1u;
+  };
+}
+
+} // namespace
+
+TEST_F(RxTest, assemble_bits_cv_read) {
+  _mock.options({.assemble_bits = true});
+  ZppPreamble(100uz);
+  uint16_t const cv{8u - 1u};
+  uint8_t const value{0b1011'0010u};
+  size_t bit{1uz};
+
+  {
+    InSequence s;
+    EXPECT_CALL(_mock,
+                transmit(ElementsAre(std::to_underlying(decup::Command::CvRead),
+                                     cv >> 0u,
+                                     cv >> 8u),
+                         decup::Timeouts::zpp_cv_read))
+      .WillOnce(Return(2u));
+    EXPECT_CALL(_mock,
+                transmit(ElementsAre(0xFFu), decup::Timeouts::zpp_cv_read))
+      .Times(Exactly(CHAR_BIT - 1))
+      .WillRepeatedly(bits(value, bit));
+  }
+
+  EXPECT_EQ(_mock.receive(std::to_underlying(decup::Command::CvRead)),
+            std::nullopt);
+  EXPECT_EQ(_mock.receive(static_cast<uint8_t>(cv >> 0u)), std::nullopt);
+  EXPECT_EQ(_mock.receive(static_cast<uint8_t>(cv >> 8u)), value);
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Zpp);
+}
+
+TEST_F(RxTest, assemble_bits_decoder_id) {
+  _mock.options({.assemble_bits = true});
+  ZppPreamble(100uz);
+  uint8_t const decoder_id{221u};
+  size_t bit{1uz};
+
+  {
+    InSequence s;
+    EXPECT_CALL(_mock,
+                transmit(ElementsAre(std::to_underlying(
+                           decup::Command::ReadDecoderType)),
+                         decup::Timeouts::zpp_decoder_id))
+      .WillOnce(Return(2u));
+    EXPECT_CALL(_mock,
+                transmit(ElementsAre(0xFFu), decup::Timeouts::zpp_decoder_id))
+      .Times(Exactly(CHAR_BIT - 1))
+      .WillRepeatedly(bits(decoder_id, bit));
+  }
+
+  EXPECT_EQ(
+    _mock.receive(std::to_underlying(decup::Command::ReadDecoderType)),
+    decoder_id);
+}
+
+TEST_F(RxTest, assemble_bits_missing_bit) {
+  _mock.options({.assemble_bits = true});
+  ZppPreamble(100uz);
+
+  // Decoder stops answering after 3rd bit
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cv_read))
+    .WillOnce(Return(2u))
+    .WillOnce(Return(1u))
+    .WillOnce(Return(2u))
+    .WillOnce(Return(0u));
+
+  // Host gets a Nak instead of waiting forever
+  _mock.receive(std::to_underlying(decup::Command::CvRead));
+  _mock.receive(0u);
+  EXPECT_EQ(_mock.receive(0u), ulf::decup_ein::nak);
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Zpp);
+}
@@ -0,0 +1,172 @@
+#include <vector>
+#include "rx_mock.hpp"
+
+using namespace testing;
+
+TEST(AsyncRxTest, receive_waits_for_complete) {
+  NiceMock<AsyncRxMock> mock;
+
+  EXPECT_CALL(mock, transmitAsync(ElementsAre(221u), _));
+  EXPECT_EQ(mock.receive(221u), std::nullopt);
+  EXPECT_TRUE(mock.pending());
+  EXPECT_EQ(mock.complete(2u), ulf::decup_ein::ack);
+  EXPECT_FALSE(mock.pending());
+
+  // Decoder ID got acknowledged, continue with block count
+  EXPECT_CALL(mock, transmitAsync(ElementsAre(100u), _));
+  EXPECT_CALL(mock, config(_));
+  EXPECT_EQ(mock.receive(100u), std::nullopt);
+  EXPECT_EQ(mock.complete(1u), ulf::decup_ein::nak);
+}
+
+TEST(AsyncRxTest, bulk_receive_stops_at_pending_transmission) {
+  NiceMock<AsyncRxMock> mock;
+  std::array<uint8_t, 3uz> const bytes{
+    std::to_underlying(decup::Command::Preamble0),
+    std::to_underlying(decup::Command::Preamble1),
+    std::to_underlying(decup::Command::Preamble0)};
+  std::array<uint8_t, 3uz> responses{};
+
+  EXPECT_CALL(mock, transmitAsync(SizeIs(1uz), _)).Times(Exactly(2));
+  auto result{mock.receive(bytes, responses)};
+  EXPECT_EQ(result.in, 1uz);
+  EXPECT_EQ(result.out, 0uz);
+  EXPECT_EQ(mock.complete(0u), std::nullopt);
+  result = mock.receive(std::span{bytes}.subspan(result.in), responses);
+  EXPECT_EQ(result.in, 1uz);
+}
+
+TEST(AsyncRxTest, reset_cancels_pending_transmission) {
+  NiceMock<AsyncRxMock> mock;
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+  EXPECT_TRUE(mock.pending());
+  mock.reset();
+  EXPECT_FALSE(mock.pending());
+  EXPECT_EQ(mock.complete(2u), std::nullopt);
+}
+
+namespace {
+
+// Walk through ZSU states up to the first block
+void enter_zsu_blocks(AsyncRxMock& mock, uint8_t decoder_id) {
+  std::array<std::pair<uint8_t, uint8_t>, 4uz> const sequence{
+    {{decoder_id, 2u}, {100u, 1u}, {0x55u, 1u}, {0xAAu, 1u}}};
+  for (auto const& [byte, pulse_count] : sequence) {
+    mock.receive(byte);
+    mock.complete(pulse_count);
+  }
+}
+
+} // namespace
+
+TEST(AsyncRxTest, zsu_block_pipelined_while_in_flight) {
+  NiceMock<AsyncRxMock> mock;
+  enter_zsu_blocks(mock, 221u);
+
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> blocks(2uz * block_size);
+  std::ranges::fill(std::span{blocks}.subspan(block_size), 0x42u);
+  std::array<uint8_t, 2uz> responses{};
+
+  {
+    InSequence s;
+    EXPECT_CALL(mock, transmitAsync(Each(0x00u), decup::Timeouts::zsu_blocks));
+    EXPECT_CALL(mock, transmitAsync(Each(0x42u), decup::Timeouts::zsu_blocks));
+  }
+
+  // Both blocks get consumed, second one while the first is in flight
+  auto result{mock.receive(blocks, responses)};
+  EXPECT_EQ(result.in, size(blocks));
+  EXPECT_EQ(result.out, 0uz);
+
+  // Acknowledging the first one immediately starts the second one
+  EXPECT_EQ(mock.complete(2u), ulf::decup_ein::ack);
+  EXPECT_TRUE(mock.pending());
+  EXPECT_EQ(mock.complete(2u), ulf::decup_ein::ack);
+  EXPECT_FALSE(mock.pending());
+}
+
+TEST(AsyncRxTest, zsu_block_nak_drops_pipelined_block) {
+  NiceMock<AsyncRxMock> mock;
+  enter_zsu_blocks(mock, 221u);
+
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> const blocks(2uz * block_size, 0x42u);
+  std::array<uint8_t, 2uz> responses{};
+
+  EXPECT_CALL(mock, transmitAsync(SizeIs(block_size), _)).Times(Exactly(2));
+
+  mock.receive(blocks, responses);
+  EXPECT_EQ(mock.complete(1u), ulf::decup_ein::nak);
+  EXPECT_FALSE(mock.pending());
+
+  // Host repeats both blocks
+  auto const result{mock.receive(std::span{blocks}.first(block_size),
+                                 responses)};
+  EXPECT_EQ(result.in, block_size);
+  EXPECT_TRUE(mock.pending());
+}
+
+TEST(AsyncRxTest, zsu_block_nak_drops_partial_pipelined_block) {
+  NiceMock<AsyncRxMock> mock;
+  enter_zsu_blocks(mock, 221u);
+
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> blocks(2uz * block_size);
+  std::ranges::fill(std::span{blocks}.subspan(block_size), 0x42u);
+  auto const half{block_size / 2uz};
+  std::array<uint8_t, 2uz> responses{};
+
+  // First block and half of the second one
+  EXPECT_CALL(mock, transmitAsync(Each(0x00u), _)).Times(Exactly(2));
+  auto const result{
+    mock.receive(std::span{blocks}.first(block_size + half), responses)};
+  EXPECT_EQ(result.in, block_size + half);
+  EXPECT_EQ(mock.complete(1u), ulf::decup_ein::nak);
+
+  // Rest of the second block gets dropped, byte-wise as well as in bulk
+  EXPECT_EQ(mock.receive(blocks[block_size + half]), std::nullopt);
+  mock.receive(std::span{blocks}.subspan(block_size + half + 1uz), responses);
+  EXPECT_FALSE(mock.pending());
+
+  // Host repeats first block, which lines up again
+  mock.receive(std::span{blocks}.first(block_size), responses);
+  EXPECT_TRUE(mock.pending());
+}
+
+TEST(AsyncRxTest, zsu_block_validate_rejects_pipelined_block) {
+  NiceMock<AsyncRxMock> mock;
+  mock.options({.validate = true});
+  enter_zsu_blocks(mock, 221u);
+
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> blocks(2uz * block_size, 0x42u);
+  auto const first{std::span{blocks}.first(block_size)};
+  auto const second{std::span{blocks}.subspan(block_size)};
+  first[0uz] = 0u;
+  first.back() = decup::exor(first.first(block_size - 1uz));
+  second[0uz] = 1u;
+  second.back() = static_cast<uint8_t>(
+    decup::exor(second.first(block_size - 1uz)) ^ 0x01u);
+  std::array<uint8_t, 2uz> responses{};
+
+  // Corrupt second block never gets transmitted
+  EXPECT_CALL(mock, transmitAsync(SizeIs(block_size), _)).Times(Exactly(1));
+  auto result{mock.receive(blocks, responses)};
+  EXPECT_EQ(result.in, size(blocks));
+  EXPECT_EQ(result.out, 0uz);
+
+  // First one gets acknowledged, Nak of second one follows right after
+  EXPECT_EQ(mock.complete(2u), ulf::decup_ein::ack);
+  EXPECT_FALSE(mock.pending());
+  result = mock.receive(std::span<uint8_t const>{}, responses);
+  EXPECT_EQ(result.out, 1uz);
+  EXPECT_EQ(responses[0uz], ulf::decup_ein::nak);
+
+  // Host repeats second block
+  second.back() ^= 0x01u;
+  EXPECT_CALL(mock, transmitAsync(ElementsAreArray(second), _));
+  result = mock.receive(second, responses);
+  EXPECT_EQ(result.out, 0uz);
+  EXPECT_EQ(mock.complete(2u), ulf::decup_ein::ack);
+}
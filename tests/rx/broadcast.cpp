@@ -0,0 +1,177 @@
+#include <vector>
+#include "rx_mock.hpp"
+
+using namespace testing;
+
+namespace {
+
+// Synchronous channel answering with given pulse counts
+auto answer(BroadcastRxMock& mock, std::array<uint8_t, 3uz> pulse_counts) {
+  return [&mock, pulse_counts](size_t channel, auto, auto) {
+    mock.complete(channel, pulse_counts[channel]);
+  };
+}
+
+// Walk through ZSU states up to the first block, all channels agreeing
+void enter_zsu_blocks(BroadcastRxMock& mock) {
+  std::array<std::pair<uint8_t, uint8_t>, 4uz> const sequence{
+    {{221u, 2u}, {100u, 1u}, {0x55u, 1u}, {0xAAu, 1u}}};
+  for (auto const& [byte, pulse_count] : sequence) {
+    EXPECT_CALL(mock, transmitChannel(_, _, _))
+      .WillRepeatedly(answer(mock, {pulse_count, pulse_count, pulse_count}));
+    mock.receive(byte);
+  }
+  Mock::VerifyAndClearExpectations(&mock);
+}
+
+// Receive ZSU block byte by byte
+std::optional<uint8_t> receive_block(BroadcastRxMock& mock, uint8_t index) {
+  std::vector<uint8_t> block(decup::decoder_id2block_size(221u) + 2uz);
+  block.front() = index;
+  block.back() = decup::exor(std::span{block}.first(size(block) - 1uz));
+  std::optional<uint8_t> retval;
+  for (auto const byte : block) retval = mock.receive(byte);
+  return retval;
+}
+
+} // namespace
+
+TEST(BroadcastRxTest, aggregate_and_fail_missing_decoder) {
+  NiceMock<BroadcastRxMock> mock;
+
+  // Channel 2 has no decoder connected
+  EXPECT_CALL(mock, transmitChannel(_, ElementsAre(221u), _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 2u, 0u}));
+  EXPECT_EQ(mock.receive(221u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.failed(), 0b100u);
+
+  // Failed channels are skipped
+  EXPECT_CALL(mock, transmitChannel(2uz, _, _)).Times(Exactly(0));
+  EXPECT_CALL(mock, transmitChannel(_, ElementsAre(100u), _))
+    .Times(Exactly(2))
+    .WillRepeatedly(answer(mock, {1u, 1u, 0u}));
+  EXPECT_EQ(mock.receive(100u), ulf::decup_ein::nak);
+  EXPECT_EQ(mock.failed(), 0b100u);
+}
+
+TEST(BroadcastRxTest, fail_disagreeing_channel) {
+  NiceMock<BroadcastRxMock> mock;
+
+  // Decoder ID isn't repeated by the host, channel 1 is out of sync
+  EXPECT_CALL(mock, transmitChannel(_, ElementsAre(221u), _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 1u, 2u}));
+  EXPECT_EQ(mock.receive(221u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.failed(), 0b010u);
+  EXPECT_EQ(mock.retries(1uz), 0uz);
+}
+
+TEST(BroadcastRxTest, fail_disagreeing_bit) {
+  NiceMock<BroadcastRxMock> mock;
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .WillRepeatedly(answer(mock, {0u, 0u, 0u}));
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+  mock.receive(std::to_underlying(decup::Command::Preamble1));
+  Mock::VerifyAndClearExpectations(&mock);
+
+  // Channel 0 reads a different decoder type bit, which mustn't be repeated
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 1u, 1u}));
+  EXPECT_EQ(
+    mock.receive(std::to_underlying(decup::Command::ReadDecoderType)),
+    ulf::decup_ein::nak);
+  EXPECT_EQ(mock.failed(), 0b001u);
+}
+
+TEST(BroadcastRxTest, repeat_nak_on_single_channel) {
+  NiceMock<BroadcastRxMock> mock;
+  enter_zsu_blocks(mock);
+  std::array<uint8_t, 3uz> pulse_counts{2u, 1u, 2u};
+  ON_CALL(mock, transmitChannel(_, _, _))
+    .WillByDefault([&](size_t channel, auto, auto) {
+      auto const pulse_count{pulse_counts[channel]};
+      pulse_counts[channel] = 2u;
+      mock.complete(channel, pulse_count);
+    });
+
+  EXPECT_CALL(mock, transmitChannel(0uz, _, _)).Times(Exactly(1));
+  EXPECT_CALL(mock, transmitChannel(1uz, _, _)).Times(Exactly(2));
+  EXPECT_CALL(mock, transmitChannel(2uz, _, _)).Times(Exactly(1));
+  EXPECT_EQ(receive_block(mock, 0u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.failed(), 0u);
+  EXPECT_EQ(mock.retries(1uz), 1uz);
+}
+
+TEST(BroadcastRxTest, keep_ack_on_nak_majority) {
+  NiceMock<BroadcastRxMock> mock;
+  enter_zsu_blocks(mock);
+
+  // Channel 0 accepts while the others Nak
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 1u, 1u}));
+  EXPECT_EQ(receive_block(mock, 0u), ulf::decup_ein::nak);
+  EXPECT_EQ(mock.failed(), 0u);
+
+  // Repeat only goes out on channels which rejected it
+  EXPECT_CALL(mock, transmitChannel(0uz, _, _)).Times(Exactly(0));
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .Times(Exactly(2))
+    .WillRepeatedly(answer(mock, {2u, 2u, 2u}));
+  EXPECT_EQ(receive_block(mock, 0u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.failed(), 0u);
+}
+
+TEST(BroadcastRxTest, fail_ack_on_nak_majority_without_repeat) {
+  NiceMock<BroadcastRxMock> mock;
+  enter_zsu_blocks(mock);
+
+  // Channel 0 accepts while the others Nak
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 1u, 1u}));
+  EXPECT_EQ(receive_block(mock, 0u), ulf::decup_ein::nak);
+
+  // Host moves on, channel 0 is out of sync
+  EXPECT_CALL(mock, transmitChannel(0uz, _, _)).Times(Exactly(0));
+  EXPECT_CALL(mock, transmitChannel(_, _, _))
+    .Times(Exactly(2))
+    .WillRepeatedly(answer(mock, {0u, 2u, 2u}));
+  EXPECT_EQ(receive_block(mock, 1u), ulf::decup_ein::ack);
+  EXPECT_EQ(mock.failed(), 0b001u);
+
+  // Reset brings it back
+  mock.reset();
+  EXPECT_EQ(mock.failed(), 0u);
+}
+
+TEST(BroadcastRxTest, reset_through_base) {
+  NiceMock<BroadcastRxMock> mock;
+  EXPECT_CALL(mock, transmitChannel(_, ElementsAre(221u), _))
+    .Times(Exactly(3))
+    .WillRepeatedly(answer(mock, {2u, 2u, 0u}));
+  EXPECT_EQ(mock.receive(221u), ulf::decup_ein::ack);
+  EXPECT_CALL(mock, transmitChannel(_, ElementsAre(100u), _))
+    .Times(Exactly(2));
+  EXPECT_EQ(mock.receive(100u), std::nullopt);
+
+  // Failures and channels still outstanding get dropped
+  static_cast<ulf::decup_ein::rx::AsyncBase&>(mock).reset();
+  EXPECT_EQ(mock.failed(), 0u);
+  EXPECT_EQ(mock.complete(0uz, 1u), std::nullopt);
+  EXPECT_EQ(mock.complete(1uz, 1u), std::nullopt);
+  EXPECT_FALSE(mock.pending());
+}
+
+TEST(BroadcastRxTest, asynchronous_completion) {
+  NiceMock<BroadcastRxMock> mock;
+  EXPECT_CALL(mock, transmitChannel(_, _, _)).Times(Exactly(3));
+  EXPECT_EQ(mock.receive(221u), std::nullopt);
+  EXPECT_EQ(mock.complete(0uz, 2u), std::nullopt);
+  EXPECT_EQ(mock.complete(2uz, 2u), std::nullopt);
+  EXPECT_TRUE(mock.pending());
+  EXPECT_EQ(mock.complete(1uz, 2u), ulf::decup_ein::ack);
+  EXPECT_FALSE(mock.pending());
+}
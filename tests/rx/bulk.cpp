@@ -0,0 +1,162 @@
+#include <ranges>
+#include <vector>
+#include "../utility.hpp"
+#include "rx_test.hpp"
+
+using namespace testing;
+
+namespace {
+
+// Receive stream in USB full-speed sized transfers
+std::vector<uint8_t> receive_chunked(RxMock& mock,
+                                     std::vector<uint8_t> const& stream) {
+  std::vector<uint8_t> responses(size(stream));
+  size_t in{}, out{};
+  while (in < size(stream)) {
+    auto const count{std::min(64uz, size(stream) - in)};
+    auto const result{mock.receive(std::span{data(stream) + in, count},
+                                   std::span{responses}.subspan(out))};
+    EXPECT_EQ(result.in, count);
+    in += result.in;
+    out += result.out;
+  }
+  responses.resize(out);
+  return responses;
+}
+
+} // namespace
+
+TEST_F(RxTest, bulk_zsu) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const& fw{_zsu.firmwares.back()};
+  auto const decoder_id{static_cast<uint8_t>(fw.id)};
+  auto const block_count{static_cast<uint8_t>(size(fw.bin) / 256u + 8u - 1u)};
+  auto const block_size{decup::decoder_id2block_size(decoder_id)};
+
+  std::vector<uint8_t> stream(100uz,
+                              std::to_underlying(decup::Command::Preamble0));
+  stream.insert(end(stream), {decoder_id, block_count, 0x55u, 0xAAu});
+  auto const blocks{(size(fw.bin) + block_size - 1uz) / block_size};
+  uint8_t count{0u};
+  for (auto chunk : fw.bin | std::views::chunk(block_size)) {
+    stream.push_back(count);
+    stream.insert(end(stream), begin(chunk), end(chunk));
+    stream.push_back(count++ ^ decup::exor(chunk));
+  }
+
+  EXPECT_CALL(_mock, transmit(SizeIs(1uz), _)).WillRepeatedly(Return(0u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(decoder_id), _))
+    .WillOnce(Return(2u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(block_count), _))
+    .WillOnce(Return(1u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(0x55u), _)).WillOnce(Return(1u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(0xAAu), _)).WillOnce(Return(1u));
+  EXPECT_CALL(_mock, transmit(SizeIs(block_size + 2uz), _))
+    .Times(Exactly(static_cast<int>(blocks)))
+    .WillRepeatedly(Return(2u));
+
+  auto const responses{receive_chunked(_mock, stream)};
+  ASSERT_EQ(size(responses), 4uz + blocks);
+  EXPECT_EQ(responses[0uz], ulf::decup_ein::ack);
+  EXPECT_EQ(responses[1uz], ulf::decup_ein::nak);
+  EXPECT_TRUE(std::ranges::all_of(responses | std::views::drop(4uz),
+                                  [](uint8_t r) {
+                                    return r == ulf::decup_ein::ack;
+                                  }));
+}
+
+TEST_F(RxTest, bulk_zpp_flash_write) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+
+  std::vector<uint8_t> stream(100uz,
+                              std::to_underlying(decup::Command::Preamble1));
+  uint16_t block{0u};
+  for (auto chunk : _zpp.flash | std::views::chunk(256u)) {
+    stream.insert(end(stream),
+                  {0x05u,
+                   0x55u,
+                   static_cast<uint8_t>(block >> 0u),
+                   static_cast<uint8_t>(block >> 8u)});
+    stream.insert(end(stream), begin(chunk), end(chunk));
+    stream.push_back(decup::crc8(chunk, 0x55u));
+    ++block;
+  }
+
+  EXPECT_CALL(_mock, transmit(SizeIs(1uz), _)).WillRepeatedly(Return(0u));
+  EXPECT_CALL(_mock,
+              transmit(SizeIs(DECUP_MAX_PACKET_SIZE),
+                       decup::Timeouts::zpp_flash_write))
+    .Times(Exactly(block))
+    .WillRepeatedly(Return(2u));
+
+  auto const responses{receive_chunked(_mock, stream)};
+  EXPECT_EQ(size(responses), block);
+}
+
+TEST_F(RxTest, bulk_stops_on_full_responses) {
+  std::vector<uint8_t> const stream(
+    10uz, std::to_underlying(decup::Command::Preamble0));
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(2u));
+  std::array<uint8_t, 4uz> responses{};
+  auto const result{_mock.receive(stream, responses)};
+  EXPECT_EQ(result.in, 4uz);
+  EXPECT_EQ(result.out, 4uz);
+}
+
+TEST_F(RxTest, bulk_zsu_blocks_zero_copy) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const& fw{_zsu.firmwares.back()};
+  auto const decoder_id{static_cast<uint8_t>(fw.id)};
+  auto const block_size{decup::decoder_id2block_size(decoder_id)};
+
+  std::vector<uint8_t> stream{decoder_id, 100u, 0x55u, 0xAAu};
+  uint8_t count{0u};
+  for (auto chunk :
+       fw.bin | std::views::chunk(block_size) | std::views::take(8uz)) {
+    stream.push_back(count);
+    stream.insert(end(stream), begin(chunk), end(chunk));
+    stream.push_back(count++ ^ decup::exor(chunk));
+  }
+
+  EXPECT_CALL(_mock, transmit(SizeIs(1uz), _)).WillRepeatedly(Return(1u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(decoder_id), _))
+    .WillOnce(Return(2u));
+
+  // Blocks get transmitted straight out of the input
+  auto const first{data(stream)}, last{data(stream) + size(stream)};
+  EXPECT_CALL(_mock, transmit(SizeIs(block_size + 2uz), _))
+    .Times(Exactly(8))
+    .WillRepeatedly([&](std::span<uint8_t const> bytes, uint32_t) {
+      EXPECT_GE(data(bytes), first);
+      EXPECT_LE(data(bytes) + size(bytes), last);
+      return 2u;
+    });
+
+  std::vector<uint8_t> responses(size(stream));
+  auto const result{_mock.receive(stream, responses)};
+  EXPECT_EQ(result.in, size(stream));
+  EXPECT_EQ(result.out, 4uz + 8uz);
+}
+
+TEST_F(RxTest, bulk_preamble_burst) {
+  _mock.options({.preamble_burst = true});
+
+  std::vector<uint8_t> stream{
+    'D', 'E', 'C', 'U', 'P', '_', 'E', 'I', 'N', '\r'};
+  for (auto i{0uz}; i < 300uz; ++i)
+    stream.push_back(std::to_underlying(i % 3uz ? decup::Command::Preamble0
+                                                : decup::Command::Preamble1));
+
+  // One transmission per transfer, first one shortened by entry string
+  EXPECT_CALL(_mock, transmit(SizeIs(64uz), decup::Timeouts::zpp_preamble))
+    .Times(Exactly(3))
+    .WillRepeatedly(Return(0u));
+  EXPECT_CALL(_mock, transmit(SizeIs(54uz), decup::Timeouts::zpp_preamble))
+    .WillOnce(Return(0u))
+    .WillOnce(Return(2u));
+
+  // Only bursts which saw pulses get answered
+  EXPECT_THAT(receive_chunked(_mock, stream),
+              ElementsAre(ulf::decup_ein::ack));
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Preamble);
+}
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include "../tx/tx_test.hpp"
+#include "../utility.hpp"
+#include "sim_decoder.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::Engine;
+using ulf::decup_ein::rx::Options;
+using ulf::decup_ein::rx::State;
+using ulf::decup_ein::tx::ZppSession;
+using ulf::decup_ein::tx::ZsuSession;
+
+namespace {
+
+// Everything a receiver did to its backend
+struct Log {
+  bool operator==(Log const&) const = default;
+
+  std::vector<std::pair<std::vector<uint8_t>, uint32_t>> transmissions;
+  std::vector<std::pair<uint8_t, uint32_t>> configs;
+};
+
+// Simulated decoder which logs what it got
+struct LoggingSim {
+  explicit LoggingSim(SimDecoder::Config config) : sim{config} {}
+
+  uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout) {
+    log.transmissions.push_back({{cbegin(bytes), cend(bytes)}, timeout});
+    return sim.answer(bytes);
+  }
+
+  void config(uint8_t stop_bits) {
+    sim.stop_bits = stop_bits;
+    log.configs.push_back({stop_bits, 0u});
+  }
+
+  bool configUart(uint8_t stop_bits, uint32_t baud_rate) {
+    if (baud_rate > sim.cfg.max_uart_baud_rate) return false;
+    sim.stop_bits = stop_bits;
+    sim.baud_rate = baud_rate;
+    log.configs.push_back({stop_bits, baud_rate});
+    return true;
+  }
+
+  SimDecoder sim;
+  Log log;
+};
+
+// Engine in front of simulated decoder
+template<size_t BlockSize = 0uz>
+struct SimEngine : Engine<SimEngine<BlockSize>, BlockSize>, LoggingSim {
+  explicit SimEngine(SimDecoder::Config config) : LoggingSim{config} {}
+
+  using LoggingSim::config;
+  using LoggingSim::configUart;
+  using LoggingSim::transmit;
+};
+
+// Base in front of simulated decoder
+struct SimBase : ulf::decup_ein::rx::Base, LoggingSim {
+  using LoggingSim::LoggingSim;
+
+private:
+  uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout) final {
+    return LoggingSim::transmit(bytes, timeout);
+  }
+
+  void config(uint8_t stop_bits) final { LoggingSim::config(stop_bits); }
+
+  bool configUart(uint8_t stop_bits, uint32_t baud_rate) final {
+    return LoggingSim::configUart(stop_bits, baud_rate);
+  }
+};
+
+// Engine must do exactly what Base does
+template<typename Session>
+void expect_same_as_base(Session reference_session,
+                         Session session,
+                         Options options,
+                         SimDecoder::Config config) {
+  SimBase base{config};
+  base.options(options);
+  send(reference_session, base);
+
+  SimEngine engine{config};
+  engine.options(options);
+  send(session, engine);
+
+  EXPECT_EQ(session.state(), reference_session.state());
+  EXPECT_EQ(engine.state(), base.state());
+  EXPECT_EQ(engine.skipped(), base.skipped());
+  EXPECT_EQ(engine.log, base.log);
+}
+
+} // namespace
+
+TEST_F(RxTest, engine_zsu_mx645) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+
+  // Reference
+  ZsuSession reference_session{fws};
+  SimDecoder reference{{.decoder_id = 221u}};
+  send(reference_session, reference);
+
+  ZsuSession session{fws};
+  SimEngine engine{{.decoder_id = 221u}};
+  send(session, engine);
+
+  ASSERT_EQ(session.state(), ZsuSession::State::Done);
+  EXPECT_TRUE(engine.sim.verify(session.firmware()->bin));
+  EXPECT_EQ(engine.sim.stop_bits, 2u);
+  EXPECT_EQ(size(engine.log.transmissions), reference.transmissions);
+  EXPECT_EQ(engine.state(), reference.state());
+}
+
+TEST_F(RxTest, engine_zsu_block_size) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+
+  // Matching block size
+  ZsuSession session64{fws};
+  SimEngine<64uz> engine64{{.decoder_id = 221u}};
+  send(session64, engine64);
+  ASSERT_EQ(session64.state(), ZsuSession::State::Done);
+  EXPECT_TRUE(engine64.sim.verify(session64.firmware()->bin));
+
+  // Decoder gets ignored
+  ZsuSession session32{fws, 10uz, 3u};
+  SimEngine<32uz> engine32{{.decoder_id = 221u}};
+  send(session32, engine32);
+  EXPECT_EQ(session32.state(), ZsuSession::State::Failed);
+  EXPECT_EQ(engine32.state(), State::ZsuDecoderId);
+}
+
+TEST_F(RxTest, engine_zpp) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+  ZppSession session{_zpp.flash};
+  SimEngine engine{{.nak_probability = 0.01, .seed = 7u}};
+
+  send(session, engine);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(engine.sim.verify(_zpp.flash));
+  EXPECT_EQ(engine.sim.stop_bits, 2u);
+  EXPECT_EQ(engine.state(), State::Zpp);
+}
+
+TEST_F(RxTest, engine_zpp_high_speed) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+
+  // Reference at DECUP baud rate
+  ZppSession reference_session{_zpp.flash};
+  SimEngine reference{{}};
+  send(reference_session, reference);
+
+  for (auto const max_baud_rate : {0u, 57600u, 115200u}) {
+    ZppSession session{_zpp.flash};
+    SimEngine engine{{.max_baud_rate = max_baud_rate}};
+    engine.options({.high_speed = 115200u});
+    send(session, engine);
+
+    ASSERT_EQ(session.state(), ZppSession::State::Done);
+    EXPECT_TRUE(engine.sim.verify(_zpp.flash));
+    auto const baud_rate{max_baud_rate == 115200u ? 115200u : 0u};
+    EXPECT_EQ(engine.sim.baud_rate, baud_rate);
+    EXPECT_EQ(engine.sim.decoder_baud_rate, baud_rate);
+  }
+
+  // Bridge which can't switch doesn't ask
+  ZppSession session{_zpp.flash};
+  SimEngine engine{{.max_baud_rate = 115200u, .max_uart_baud_rate = 57600u}};
+  engine.options({.high_speed = 115200u});
+  send(session, engine);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(engine.sim.verify(_zpp.flash));
+  EXPECT_EQ(engine.sim.baud_rate, 0u);
+  EXPECT_EQ(engine.sim.decoder_baud_rate, 0u);
+  EXPECT_EQ(size(engine.log.transmissions),
+            size(reference.log.transmissions));
+}
+
+TEST_F(RxTest, engine_zpp_skip_erased) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+  ZppSession session{_zpp.flash};
+  SimEngine engine{{}};
+  engine.options({.skip_erased = true});
+
+  send(session, engine);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(engine.sim.verify(_zpp.flash));
+  auto const pages{std::ranges::count_if(
+    _zpp.flash | std::views::chunk(256uz),
+    [](auto const& page) { return ulf::decup_ein::erased(page); })};
+  EXPECT_EQ(engine.skipped(), static_cast<size_t>(pages));
+}
+
+TEST_F(RxTest, engine_same_as_base) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+
+  for (auto const nak_probability : {0.0, 0.05}) {
+    SimDecoder::Config const config{.max_baud_rate = 115200u,
+                                    .nak_probability = nak_probability,
+                                    .seed = 3u};
+    for (auto const options : {Options{},
+                               Options{.validate = true},
+                               Options{.assemble_bits = true},
+                               Options{.high_speed = 115200u},
+                               Options{.skip_erased = true}}) {
+      expect_same_as_base(
+        ZppSession{_zpp.flash}, ZppSession{_zpp.flash}, options, config);
+      expect_same_as_base(ZsuSession{fws}, ZsuSession{fws}, options, config);
+    }
+  }
+}
+
+TEST(EngineRxTest, assemble_bits_missing_bit) {
+  NiceMock<EngineRxMock> mock;
+  mock.options({.assemble_bits = true});
+  for (auto const byte : {std::to_underlying(decup::Command::Preamble0),
+                          std::to_underlying(decup::Command::Preamble1)})
+    mock.receive(byte);
+
+  // Host gets a Nak instead of waiting forever
+  EXPECT_CALL(mock, transmit(_, decup::Timeouts::zpp_cv_read))
+    .WillOnce(Return(2u))
+    .WillOnce(Return(0u));
+  mock.receive(std::to_underlying(decup::Command::CvRead));
+  mock.receive(0u);
+  EXPECT_EQ(mock.receive(0u), ulf::decup_ein::nak);
+  EXPECT_EQ(mock.state(), State::Zpp);
+}
+
+TEST(EngineRxTest, validate_zsu_block) {
+  NiceMock<EngineRxMock> mock;
+  mock.options({.validate = true});
+  mock.receive(std::to_underlying(decup::Command::Preamble0));
+  EXPECT_CALL(mock, transmit(ElementsAre(221u), _)).WillOnce(Return(2u));
+  mock.receive(221u);
+  for (auto const byte : {100u, 0x55u, 0xAAu}) {
+    EXPECT_CALL(mock, transmit(ElementsAre(byte), _)).WillOnce(Return(1u));
+    mock.receive(static_cast<uint8_t>(byte));
+  }
+  ASSERT_EQ(mock.state(), State::ZsuBlocks);
+
+  // Corrupt block never gets transmitted
+  std::vector<uint8_t> block(decup::decoder_id2block_size(221u) + 2uz);
+  block.back() = 0x01u;
+  EXPECT_CALL(mock, transmit(_, decup::Timeouts::zsu_blocks)).Times(0);
+  for (auto const byte : std::span{block}.first(size(block) - 1uz))
+    EXPECT_EQ(mock.receive(byte), std::nullopt);
+  EXPECT_EQ(mock.receive(block.back()), ulf::decup_ein::nak);
+  Mock::VerifyAndClearExpectations(&mock);
+
+  block.back() = 0x00u;
+  EXPECT_CALL(mock, transmit(ElementsAreArray(block), _))
+    .WillOnce(Return(2u));
+  for (auto const byte : std::span{block}.first(size(block) - 1uz))
+    mock.receive(byte);
+  EXPECT_EQ(mock.receive(block.back()), ulf::decup_ein::ack);
+}
@@ -0,0 +1,72 @@
+#include "../utility.hpp"
+#include "rx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::Metrics;
+using ulf::decup_ein::rx::State;
+
+namespace {
+
+// Clock advancing 10us each call
+uint32_t clock() {
+  static uint32_t us{};
+  return us += 10u;
+}
+
+} // namespace
+
+TEST_F(RxTest, metrics) {
+  Metrics metrics{.clock = clock};
+  _mock.metrics(&metrics);
+
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
+    .ZsuPreamble(100uz)
+    .ZsuDecoderId(221u)
+    .ZsuBlockCount()
+    .ZsuSecurityByte1()
+    .ZsuSecurityByte2()
+    .ZsuBlocks();
+
+  // Bytes and transmissions belong to the state they're handled in, including
+  // those causing a transition
+  EXPECT_EQ(metrics[State::Entry].bytes, 0u);
+  EXPECT_EQ(metrics[State::Preamble].bytes, 100u);
+  EXPECT_EQ(metrics[State::Preamble].timeouts, 100u);
+  auto const& decoder_id{metrics[State::ZsuDecoderId]};
+  EXPECT_EQ(decoder_id.bytes,
+            decoder_id.acks + decoder_id.naks + decoder_id.timeouts);
+  EXPECT_EQ(metrics[State::ZsuBlockCount].bytes, 1u);
+  EXPECT_EQ(metrics[State::ZsuSecurityByte1].bytes, 1u);
+  EXPECT_EQ(metrics[State::ZsuSecurityByte2].bytes, 1u);
+  EXPECT_EQ(metrics[State::ZsuDecoderId].acks, 1u);
+  EXPECT_EQ(metrics[State::ZsuBlockCount].naks, 1u);
+  EXPECT_EQ(metrics[State::ZsuSecurityByte1].naks, 1u);
+  EXPECT_EQ(metrics[State::ZsuSecurityByte2].naks, 1u);
+
+  auto const& blocks{metrics[State::ZsuBlocks]};
+  auto const block_size{
+    decup::decoder_id2block_size(static_cast<uint8_t>(_fw.id))};
+  EXPECT_EQ(blocks.bytes, blocks.acks * (block_size + 2uz));
+  EXPECT_EQ(blocks.time, blocks.acks * 10u);
+  EXPECT_EQ(blocks.latencies[0uz], blocks.acks);
+}
+
+TEST_F(RxTest, metrics_zpp_transitions) {
+  Metrics metrics{};
+  _mock.metrics(&metrics);
+
+  Zpp(source_location_parent_path() / "../../data/test.zpp")
+    .ZppPreamble(10uz)
+    .ZppDecoderId()
+    .ZppFlashErase();
+
+  // Commands are handled by their own states, not by ZPP itself
+  EXPECT_EQ(metrics[State::Entry].bytes, 0u);
+  EXPECT_EQ(metrics[State::Preamble].bytes, 10u);
+  EXPECT_EQ(metrics[State::Zpp].bytes, 0u);
+  EXPECT_EQ(metrics[State::Zpp].timeouts, 0u);
+  EXPECT_EQ(metrics[State::ZppDecoderId].bytes, 8u);
+  EXPECT_EQ(metrics[State::ZppDecoderId].timeouts, 8u);
+  EXPECT_EQ(metrics[State::ZppFlashErase].bytes, 4u);
+  EXPECT_EQ(metrics[State::ZppFlashErase].timeouts, 1u);
+}
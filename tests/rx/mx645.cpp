@@ -1,6 +1,10 @@
+#include <atomic>
+#include <thread>
 #include "../utility.hpp"
 #include "rx_test.hpp"
 
+using namespace testing;
+
 TEST_F(RxTest, mx645) {
   Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
     .ZsuPreamble(100uz)
@@ -10,3 +14,113 @@ TEST_F(RxTest, mx645) {
     .ZsuSecurityByte2()
     .ZsuBlocks();
 }
+
+TEST_F(RxTest, mx645_session_info) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
+    .ZsuPreamble(100uz);
+  EXPECT_FALSE(_mock.sessionInfo());
+
+  // Everything but the block count is known once decoder ID is acknowledged
+  ZsuDecoderId(221u);
+  auto info{_mock.sessionInfo()};
+  ASSERT_TRUE(info);
+  EXPECT_EQ(info->decoder_id, 221u);
+  EXPECT_EQ(info->block_size, decup::decoder_id2block_size(221u));
+  EXPECT_EQ(info->bootloader_size, decup::decoder_id2bootloader_size(221u));
+  EXPECT_EQ(info->stop_bits, 2u);
+  EXPECT_EQ(info->block_count, 0u);
+
+  ZsuBlockCount().ZsuSecurityByte1().ZsuSecurityByte2().ZsuBlocks();
+  info = _mock.sessionInfo();
+  ASSERT_TRUE(info);
+  auto const block_count{
+    ((size(_fw.bin) / 256uz + 8uz) * 256uz - info->bootloader_size) /
+    info->block_size};
+  EXPECT_EQ(info->block_count, block_count);
+  EXPECT_EQ(info->block_index, size(_fw.bin) / info->block_size);
+  EXPECT_EQ(info->byte_count, block_count * info->block_size);
+
+  _mock.reset();
+  EXPECT_FALSE(_mock.sessionInfo());
+}
+
+TEST_F(RxTest, mx645_session_info_done) {
+  ZsuPreamble(100uz);
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(1u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(221u), _))
+    .WillRepeatedly(Return(2u));
+  EXPECT_CALL(_mock, transmit(SizeIs(Gt(1uz)), decup::Timeouts::zsu_blocks))
+    .WillRepeatedly(Return(2u));
+  for (auto const byte : {221u, 10u, 0x55u, 0xAAu})
+    _mock.receive(static_cast<uint8_t>(byte));
+  auto const block_count{_mock.sessionInfo()->block_count};
+  auto const block_size{_mock.sessionInfo()->block_size};
+  ASSERT_GT(block_count, 0u);
+
+  for (auto i{0uz}; i < block_count; ++i)
+    for (auto j{0uz}; j < block_size + 2uz; ++j) _mock.receive(0u);
+
+  // Final info stays until the next session starts
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Entry);
+  auto info{_mock.sessionInfo()};
+  ASSERT_TRUE(info);
+  EXPECT_EQ(info->block_index, block_count);
+  EXPECT_EQ(info->block_count, block_count);
+
+  _mock.receive(std::to_underlying(decup::Command::Preamble0));
+  _mock.receive(221u);
+  info = _mock.sessionInfo();
+  ASSERT_TRUE(info);
+  EXPECT_EQ(info->block_index, 0u);
+  EXPECT_EQ(info->block_count, 0u);
+}
+
+TEST_F(RxTest, mx645_session_info_concurrent) {
+  ZsuPreamble(100uz);
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(1u));
+  EXPECT_CALL(_mock, transmit(ElementsAre(221u), _))
+    .WillRepeatedly(Return(2u));
+  EXPECT_CALL(_mock, transmit(SizeIs(Gt(1uz)), decup::Timeouts::zsu_blocks))
+    .WillRepeatedly(Return(2u));
+
+  // Other task polling progress must never see fields of different sessions
+  std::atomic<bool> stop{};
+  std::atomic<size_t> torn{};
+  std::thread poll{[&] {
+    while (!stop.load())
+      if (auto const info{_mock.sessionInfo()};
+          info && info->block_index > info->block_count)
+        ++torn;
+  }};
+
+  for (auto i{0uz}; i < 20uz; ++i) {
+    _mock.receive(std::to_underlying(decup::Command::Preamble0));
+    for (auto const byte : {221u, 10u, 0x55u, 0xAAu})
+      _mock.receive(static_cast<uint8_t>(byte));
+    auto const info{_mock.sessionInfo()};
+    ASSERT_TRUE(info);
+    for (auto j{0uz}; j < info->block_count * (info->block_size + 2uz); ++j)
+      _mock.receive(0u);
+  }
+
+  stop = true;
+  poll.join();
+  EXPECT_EQ(torn, 0uz);
+}
+
+TEST_F(RxTest, mx645_restore_bounds_block_count) {
+  // More blocks than any count byte announces can't be published
+  EXPECT_EQ(
+    _mock.restore({.decoder_id = 221u, .block = 4000u, .block_count = 100u}),
+    ulf::decup_ein::nak);
+  EXPECT_FALSE(_mock.sessionInfo());
+
+  EXPECT_CALL(_mock, config(_));
+  EXPECT_EQ(
+    _mock.restore({.decoder_id = 221u, .block = 2000u, .block_count = 40u}),
+    ulf::decup_ein::ack);
+  auto const info{_mock.sessionInfo()};
+  ASSERT_TRUE(info);
+  EXPECT_EQ(info->block_index, 2000u);
+  EXPECT_EQ(info->block_count, 2040u);
+}
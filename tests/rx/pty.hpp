@@ -0,0 +1,78 @@
+#pragma once
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "sim_decoder.hpp"
+
+// Latency of pty round trip including decoder thread [us]
+inline constexpr uint32_t pty_latency{20'000u};
+
+// Pseudo terminal pair, master is the far end
+struct Pty {
+  Pty() {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    grantpt(master);
+    unlockpt(master);
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    ulf::decup_ein::rx::Serial::raw(slave);
+  }
+
+  ~Pty() {
+    close(slave);
+    close(master);
+  }
+
+  int master{-1};
+  int slave{-1};
+};
+
+// Simulated decoder on far end of pty, answers with one byte per pulse
+struct PtyDecoder {
+  PtyDecoder(int fd, SimDecoder::Config config = {})
+    : sim{config}, thread{[this, fd](std::stop_token stop) { run(stop, fd); }} {
+  }
+
+  void run(std::stop_token stop, int fd) {
+    std::vector<uint8_t> frame;
+    while (!stop.stop_requested()) {
+      pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+      // Idle line ends transmission
+      timespec const timeout{.tv_sec = 0,
+                             .tv_nsec = empty(frame) ? 10'000'000 : 500'000};
+      if (ppoll(&pfd, 1u, &timeout, nullptr) > 0) {
+        std::array<uint8_t, 512uz> bytes{};
+        auto const count{read(fd, data(bytes), size(bytes))};
+        if (count > 0)
+          frame.insert(end(frame), begin(bytes), begin(bytes) + count);
+      } else if (!empty(frame)) {
+        termios tio{};
+        tcgetattr(fd, &tio);
+        sim.stop_bits = tio.c_cflag & CSTOPB ? 2u : 1u;
+        std::vector<uint8_t> const pulses(sim.answer(frame), 0x00u);
+        frame.clear();
+        write(fd, data(pulses), size(pulses));
+      }
+    }
+  }
+
+  SimDecoder sim;
+  std::jthread thread;
+};
+
+// Read single response byte
+inline std::optional<uint8_t>
+read_response(int fd, std::chrono::milliseconds timeout) {
+  pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+  if (::poll(&pfd, 1u, static_cast<int>(timeout.count())) <= 0)
+    return std::nullopt;
+  uint8_t byte{};
+  if (read(fd, &byte, sizeof(byte)) != sizeof(byte)) return std::nullopt;
+  return byte;
+}
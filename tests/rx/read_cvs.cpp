@@ -0,0 +1,69 @@
+#include <array>
+#include "rx_test.hpp"
+
+using namespace testing;
+
+namespace {
+
+// Decoder answering low byte of CV address + 1, bits MSB first
+struct Decoder {
+  uint8_t transmit(std::span<uint8_t const> bytes) {
+    if (size(bytes) == 3uz) {
+      address = static_cast<uint16_t>(bytes[1uz] | bytes[2uz] << 8u);
+      bit = 0uz;
+    }
+    // Stop answering after 3 bits
+    if (address == stall_address && bit == 3uz) return 0u;
+    auto const value{static_cast<uint8_t>(address + 1u)};
+    return value & (0x80u >> bit++) ? 2u : 1u;
+  }
+
+  uint16_t stall_address{0xFFFFu};
+  uint16_t address{};
+  size_t bit{};
+};
+
+} // namespace
+
+TEST_F(RxTest, read_cvs_range) {
+  ZppPreamble(100uz);
+
+  Decoder decoder;
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cv_read))
+    .Times(Exactly(16 * CHAR_BIT))
+    .WillRepeatedly(
+      [&](std::span<uint8_t const> bytes, uint32_t) {
+        return decoder.transmit(bytes);
+      });
+
+  std::array<uint8_t, 16uz> values{};
+  std::array<uint8_t, 2uz> errors{0xFFu, 0xFFu};
+  EXPECT_EQ(_mock.readCvs(0u, values, errors), ulf::decup_ein::ack);
+  for (auto i{0uz}; i < size(values); ++i) EXPECT_EQ(values[i], i + 1uz);
+  EXPECT_THAT(errors, Each(0u));
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Zpp);
+}
+
+TEST_F(RxTest, read_cvs_list) {
+  ZppPreamble(100uz);
+
+  Decoder decoder{.stall_address = 104u};
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cv_read))
+    .WillRepeatedly(
+      [&](std::span<uint8_t const> bytes, uint32_t) {
+        return decoder.transmit(bytes);
+      });
+
+  std::array<uint16_t const, 4uz> cvs{7u, 28u, 104u, 1022u};
+  std::array<uint8_t, 4uz> values{};
+  std::array<uint8_t, 1uz> errors{};
+  EXPECT_EQ(_mock.readCvs(cvs, values, errors), ulf::decup_ein::ack);
+  EXPECT_THAT(values, ElementsAre(8u, 29u, 0u, 0xFFu));
+  EXPECT_EQ(errors[0uz], 0b0000'0100u);
+}
+
+TEST_F(RxTest, read_cvs_requires_zpp) {
+  std::array<uint8_t, 1uz> values{};
+  std::array<uint8_t, 1uz> errors{};
+  EXPECT_EQ(_mock.readCvs(0u, values, errors), ulf::decup_ein::nak);
+}
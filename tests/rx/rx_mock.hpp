@@ -11,3 +11,25 @@ struct RxMock : ulf::decup_ein::rx::Base {
               (override));
   MOCK_METHOD(void, config, (uint8_t), (override));
 };
+
+struct BroadcastRxMock : ulf::decup_ein::rx::Broadcast {
+  BroadcastRxMock() : ulf::decup_ein::rx::Broadcast{3uz} {}
+  MOCK_METHOD(void,
+              transmitChannel,
+              (size_t, std::span<uint8_t const>, uint32_t),
+              (override));
+  MOCK_METHOD(void, config, (uint8_t), (override));
+};
+
+struct AsyncRxMock : ulf::decup_ein::rx::AsyncBase {
+  MOCK_METHOD(void,
+              transmitAsync,
+              (std::span<uint8_t const>, uint32_t),
+              (override));
+  MOCK_METHOD(void, config, (uint8_t), (override));
+};
+
+struct EngineRxMock : ulf::decup_ein::rx::Engine<EngineRxMock> {
+  MOCK_METHOD(uint8_t, transmit, (std::span<uint8_t const>, uint32_t));
+  MOCK_METHOD(void, config, (uint8_t));
+};
@@ -0,0 +1,93 @@
+#if defined(__linux__)
+
+#  include "../tx/tx_test.hpp"
+#  include "../utility.hpp"
+#  include "pty.hpp"
+
+using namespace testing;
+using namespace std::chrono_literals;
+using ulf::decup_ein::rx::Serial;
+using ulf::decup_ein::tx::ZsuSession;
+
+TEST(SerialTest, zpp_flash_erase) {
+  Pty host, decoder;
+  PtyDecoder sim{decoder.master};
+  Serial serial{host.slave, decoder.slave, pty_latency};
+
+  std::array<uint8_t, 5uz> const bytes{
+    std::to_underlying(decup::Command::Preamble0),
+    std::to_underlying(decup::Command::DeleteFlash),
+    0x55u,
+    0xFFu,
+    0xFFu};
+  write(host.master, data(bytes), size(bytes));
+  while (serial.state() != ulf::decup_ein::rx::State::Zpp)
+    ASSERT_TRUE(serial.poll(1000));
+  EXPECT_EQ(read_response(host.master, 1s), ulf::decup_ein::ack);
+
+  // ZPP switched decoder port to 2 stop bits
+  termios tio{};
+  ASSERT_EQ(tcgetattr(decoder.slave, &tio), 0);
+  EXPECT_TRUE(tio.c_cflag & CSTOPB);
+  serial.reset();
+  ASSERT_EQ(tcgetattr(decoder.slave, &tio), 0);
+  EXPECT_FALSE(tio.c_cflag & CSTOPB);
+}
+
+TEST(SerialTest, timeout) {
+  Pty host, decoder;
+  Serial serial{host.slave, decoder.slave, pty_latency};
+
+  // Nobody answers preamble, transmission times out
+  auto const byte{std::to_underlying(decup::Command::Preamble0)};
+  write(host.master, &byte, sizeof(byte));
+  auto const then{std::chrono::steady_clock::now()};
+  ASSERT_TRUE(serial.poll(1000));
+  auto const elapsed{std::chrono::steady_clock::now() - then};
+  auto const timeout{
+    std::chrono::microseconds{pty_latency + decup::Timeouts::zpp_preamble}};
+  EXPECT_GE(elapsed, timeout);
+  // Generous upper bound, only catches hangs on loaded machines
+  EXPECT_LT(elapsed, timeout + 1s);
+  EXPECT_EQ(read_response(host.master, 0ms), std::nullopt);
+}
+
+TEST_F(RxTest, serial_zsu_throughput) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+  ZsuSession session{fws, 10uz};
+
+  Pty host, decoder;
+  PtyDecoder sim{decoder.master, {.decoder_id = 221u}};
+  Serial serial{host.slave, decoder.slave, pty_latency};
+  std::jthread server{[&serial](std::stop_token stop) {
+    while (!stop.stop_requested() && serial.poll(10));
+  }};
+
+  auto const then{std::chrono::steady_clock::now()};
+  size_t bytes{};
+  while (session.state() != ZsuSession::State::Done &&
+         session.state() != ZsuSession::State::Failed) {
+    auto const preamble{session.state() == ZsuSession::State::Preamble};
+    for (auto const span : session.next()) {
+      write(host.master, data(span), size(span));
+      bytes += size(span);
+    }
+    // Preamble stays unanswered
+    session.response(preamble ? std::nullopt
+                              : read_response(host.master, 250ms));
+  }
+  auto const elapsed{std::chrono::steady_clock::now() - then};
+  server.request_stop();
+  server.join();
+  sim.thread.request_stop();
+  sim.thread.join();
+
+  ASSERT_EQ(session.state(), ZsuSession::State::Done);
+  EXPECT_TRUE(sim.sim.verify(session.firmware()->bin));
+  auto const seconds{std::chrono::duration<double>{elapsed}.count()};
+  RecordProperty("bytes_per_second",
+                 std::to_string(static_cast<double>(bytes) / seconds));
+}
+
+#endif
@@ -0,0 +1,211 @@
+#if defined(__linux__)
+
+#  include <memory>
+#  include "../tx/tx_test.hpp"
+#  include "pty.hpp"
+
+using namespace testing;
+using namespace std::chrono_literals;
+using ulf::decup_ein::rx::Server;
+using ulf::decup_ein::tx::ZppSession;
+
+namespace {
+
+// Update station with its own decoder and firmware
+struct Station {
+  explicit Station(size_t i)
+    : decoder_sim{decoder.master,
+                  {.nak_probability = 0.05, .seed = static_cast<uint32_t>(i)}},
+      flash(16uz * 256uz) {
+    for (auto j{0uz}; j < size(flash); ++j)
+      flash[j] = static_cast<uint8_t>(i + j * 3uz);
+  }
+
+  // Run ZPP session from host side
+  ZppSession::State update() {
+    ZppSession session{flash, 2uz, 10u};
+    while (session.state() != ZppSession::State::Done &&
+           session.state() != ZppSession::State::Failed) {
+      auto const preamble{session.state() == ZppSession::State::Preamble};
+      for (auto const span : session.next())
+        write(host.master, data(span), size(span));
+      // Preamble stays unanswered
+      session.response(preamble ? std::nullopt
+                                : read_response(host.master, 1s));
+    }
+    return session.state();
+  }
+
+  Pty host, decoder;
+  PtyDecoder decoder_sim;
+  std::vector<uint8_t> flash;
+};
+
+// Fill port until it stops taking bytes
+size_t fill(int fd) {
+  std::array<uint8_t, 256uz> const bytes{};
+  size_t filled{};
+  for (ssize_t count{}; (count = write(fd, data(bytes), size(bytes))) > 0;)
+    filled += static_cast<size_t>(count);
+  return filled;
+}
+
+} // namespace
+
+TEST(ServerTest, sessions) {
+  constexpr size_t count{64uz};
+  std::vector<std::unique_ptr<Station>> stations;
+  for (auto i{0uz}; i < count; ++i)
+    stations.push_back(std::make_unique<Station>(i));
+
+  Server server{4uz};
+  for (auto const& station : stations)
+    ASSERT_TRUE(server.add({.host = station->host.slave,
+                            .decoder = station->decoder.slave,
+                            .latency = pty_latency}));
+  EXPECT_EQ(server.sessions(), count);
+
+  // Update all stations at once
+  std::vector<ZppSession::State> states(count);
+  {
+    std::vector<std::jthread> hosts;
+    for (auto i{0uz}; i < count; ++i)
+      hosts.emplace_back([&, i] { states[i] = stations[i]->update(); });
+  }
+  EXPECT_THAT(states, Each(ZppSession::State::Done));
+
+  for (auto const& station : stations) {
+    station->decoder_sim.thread.request_stop();
+    station->decoder_sim.thread.join();
+    EXPECT_TRUE(station->decoder_sim.sim.verify(station->flash));
+  }
+
+  // Sessions close once their host hangs up
+  for (auto const& station : stations) {
+    close(station->host.master);
+    station->host.master = -1;
+  }
+  for (auto i{0uz}; i < 100uz && server.sessions(); ++i)
+    std::this_thread::sleep_for(10ms);
+  EXPECT_EQ(server.sessions(), 0uz);
+}
+
+TEST(ServerTest, reuse_closed_session) {
+  Server server{2uz};
+  auto const first{std::make_unique<Station>(0uz)};
+  auto const session{server.add({.host = first->host.slave,
+                                 .decoder = first->decoder.slave,
+                                 .latency = pty_latency})};
+  ASSERT_TRUE(session);
+  close(first->host.master);
+  first->host.master = -1;
+  for (auto i{0uz}; i < 100uz && server.sessions(); ++i)
+    std::this_thread::sleep_for(10ms);
+  EXPECT_TRUE(session->closed());
+  EXPECT_EQ(server.sessions(), 0uz);
+
+  // Next station takes over the slot
+  auto const second{std::make_unique<Station>(1uz)};
+  EXPECT_EQ(server.add({.host = second->host.slave,
+                        .decoder = second->decoder.slave,
+                        .latency = pty_latency}),
+            session);
+  EXPECT_FALSE(session->closed());
+  EXPECT_EQ(server.sessions(), 1uz);
+  EXPECT_EQ(second->update(), ZppSession::State::Done);
+  second->decoder_sim.thread.request_stop();
+  second->decoder_sim.thread.join();
+  EXPECT_TRUE(second->decoder_sim.sim.verify(second->flash));
+}
+
+TEST(ServerTest, zsu_nak_of_corrupt_pipelined_block) {
+  Pty host, decoder;
+  PtyDecoder decoder_sim{decoder.master, {.decoder_id = 221u}};
+  Server server{1uz};
+  auto const session{server.add({.host = host.slave,
+                                 .decoder = decoder.slave,
+                                 .latency = pty_latency})};
+  ASSERT_TRUE(session);
+  session->options({.validate = true});
+
+  // Decoder ID, block count and security bytes
+  std::array<std::pair<uint8_t, uint8_t>, 4uz> const sequence{
+    {{221u, ulf::decup_ein::ack},
+     {100u, ulf::decup_ein::nak},
+     {0x55u, ulf::decup_ein::nak},
+     {0xAAu, ulf::decup_ein::nak}}};
+  for (auto const& [byte, response] : sequence) {
+    write(host.master, &byte, sizeof(byte));
+    EXPECT_EQ(read_response(host.master, 1s), response);
+  }
+
+  // Second block is corrupt
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> blocks(2uz * block_size, 0x42u);
+  auto const first{std::span{blocks}.first(block_size)};
+  auto const second{std::span{blocks}.subspan(block_size)};
+  first[0uz] = 0u;
+  first.back() = decup::exor(first.first(block_size - 1uz));
+  second[0uz] = 1u;
+  second.back() = static_cast<uint8_t>(
+    decup::exor(second.first(block_size - 1uz)) ^ 0x01u);
+
+  // Both get answered without the host sending anything else
+  write(host.master, data(blocks), size(blocks));
+  EXPECT_EQ(read_response(host.master, 1s), ulf::decup_ein::ack);
+  EXPECT_EQ(read_response(host.master, 1s), ulf::decup_ein::nak);
+
+  // Only first one reached the decoder
+  decoder_sim.thread.request_stop();
+  decoder_sim.thread.join();
+  EXPECT_EQ(size(decoder_sim.sim.flash), block_size - 2uz);
+}
+
+TEST(ServerTest, response_waits_for_host) {
+  Pty host, decoder;
+  PtyDecoder decoder_sim{decoder.master, {.decoder_id = 221u}};
+  Server server{1uz};
+  ASSERT_TRUE(server.add({.host = host.slave,
+                          .decoder = decoder.slave,
+                          .latency = pty_latency}));
+
+  // Host doesn't read, so its port can't take the response
+  auto const filled{fill(host.slave)};
+  uint8_t const decoder_id{221u};
+  write(host.master, &decoder_id, sizeof(decoder_id));
+
+  // Response follows once host drained its port
+  std::vector<uint8_t> bytes;
+  while (size(bytes) <= filled)
+    if (auto const byte{read_response(host.master, 1s)})
+      bytes.push_back(*byte);
+    else break;
+  ASSERT_EQ(size(bytes), filled + 1uz);
+  EXPECT_EQ(bytes.back(), ulf::decup_ein::ack);
+
+  decoder_sim.thread.request_stop();
+  decoder_sim.thread.join();
+}
+
+TEST(ServerTest, stop_while_host_blocks) {
+  Pty host, decoder;
+  PtyDecoder decoder_sim{decoder.master, {.decoder_id = 221u}};
+  auto server{std::make_unique<Server>(1uz)};
+  ASSERT_TRUE(server->add({.host = host.slave,
+                           .decoder = decoder.slave,
+                           .latency = pty_latency}));
+  fill(host.slave);
+  uint8_t const decoder_id{221u};
+  write(host.master, &decoder_id, sizeof(decoder_id));
+  std::this_thread::sleep_for(100ms);
+
+  // Workers don't wait for host
+  auto const then{std::chrono::steady_clock::now()};
+  server.reset();
+  EXPECT_LT(std::chrono::steady_clock::now() - then, 1s);
+
+  decoder_sim.thread.request_stop();
+  decoder_sim.thread.join();
+}
+
+#endif
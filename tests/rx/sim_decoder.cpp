@@ -0,0 +1,167 @@
+#include "sim_decoder.hpp"
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+SimDecoder::SimDecoder() : SimDecoder{Config{}} {}
+
+SimDecoder::SimDecoder(Config config) : cfg{config}, _rng{config.seed} {}
+
+// Flash matches image, everything past it is erased (and so is flash which
+// never got written)
+bool SimDecoder::verify(std::span<uint8_t const> image) const {
+  auto const is_erased{[](uint8_t byte) { return byte == 0xFFu; }};
+  auto const n{std::min(size(flash), size(image))};
+  return std::ranges::equal(image.first(n), std::span{flash}.first(n)) &&
+         std::ranges::all_of(image.subspan(n), is_erased) &&
+         std::ranges::all_of(std::span{flash}.subspan(n), is_erased);
+}
+
+uint8_t SimDecoder::transmit(std::span<uint8_t const> bytes,
+                             uint32_t timeout) {
+  ++transmissions;
+  // Start bit, data bits and stop bits per byte
+  auto const bits{size(bytes) * (1uz + CHAR_BIT + stop_bits)};
+  time += bits * 1'000'000uz / (baud_rate ? baud_rate : cfg.baud_rate);
+  // Decoder only sees garbage if baud rates differ
+  auto const pulse_count{
+    baud_rate == decoder_baud_rate ? answer(bytes) : uint8_t{}};
+  if (!pulse_count) {
+    ++timeouts;
+    time += timeout;
+  } else {
+    if (pulse_count == 1u) ++naks;
+    time += cfg.ack_latency + pulse_count * cfg.pulse_time;
+  }
+  return pulse_count;
+}
+
+void SimDecoder::config(uint8_t bits) { stop_bits = bits; }
+
+bool SimDecoder::configUart(uint8_t bits, uint32_t rate) {
+  if (rate > cfg.max_uart_baud_rate) return false;
+  stop_bits = bits;
+  baud_rate = rate;
+  return true;
+}
+
+uint8_t SimDecoder::answer(std::span<uint8_t const> bytes) {
+  switch (mode) {
+    case Mode::Preamble:
+      // Preamble (or bursts of it) stays unanswered
+      if (std::ranges::all_of(bytes, [](uint8_t byte) {
+            return byte == std::to_underlying(decup::Command::Preamble0) ||
+                   byte == std::to_underlying(decup::Command::Preamble1);
+          }))
+        return 0u;
+      mode = bytes[0uz] < 0x80u ? Mode::Zpp : Mode::Zsu;
+      return answer(bytes);
+    case Mode::Zsu: return zsu(bytes);
+    case Mode::Zpp: return zpp(bytes);
+  }
+  return 0u;
+}
+
+uint8_t SimDecoder::zsu(std::span<uint8_t const> bytes) {
+  switch (_zsu_phase) {
+    // Only decoder with matching ID answers
+    case 0uz:
+      if (size(bytes) != 1uz || bytes[0uz] != cfg.decoder_id) return 0u;
+      ++_zsu_phase;
+      return 2u;
+    // Block count
+    case 1uz: ++_zsu_phase; return 1u;
+    // Security bytes
+    case 2uz:
+      if (bytes[0uz] != 0x55u) return 0u;
+      ++_zsu_phase;
+      return 1u;
+    case 3uz:
+      if (bytes[0uz] != 0xAAu) return 0u;
+      ++_zsu_phase;
+      return 1u;
+  }
+
+  // Blocks
+  auto const block_size{decup::decoder_id2block_size(cfg.decoder_id)};
+  if (size(bytes) != block_size + 2uz) return 0u;
+  // Bootloaders other than the 256 byte ones miss bytes with 1 stop bit
+  if (decup::decoder_id2bootloader_size(cfg.decoder_id) != 256uz &&
+      stop_bits < 2u)
+    return 0u;
+  if (decup::exor(bytes) || bytes[0uz] != static_cast<uint8_t>(_block) ||
+      corrupt())
+    return 1u;
+  write(_block++ * block_size, bytes.subspan(1uz, block_size));
+  return 2u;
+}
+
+uint8_t SimDecoder::zpp(std::span<uint8_t const> bytes) {
+  // Dummy bytes clock out bits, pending baud rate switch follows last one
+  if (_bit_count) {
+    auto const pulse_count{bit()};
+    if (!_bit_count && _next_baud_rate)
+      decoder_baud_rate = std::exchange(_next_baud_rate, 0u);
+    return pulse_count;
+  }
+
+  switch (bytes[0uz]) {
+    case std::to_underlying(decup::Command::CvRead): {
+      if (size(bytes) != 3uz) return 0u;
+      auto const address{static_cast<size_t>(bytes[1uz] | bytes[2uz] << 8u)};
+      _bits = cvs[address % size(cvs)];
+      _bit_count = CHAR_BIT;
+      return bit();
+    }
+    case std::to_underlying(decup::Command::ReadDecoderType):
+      _bits = cfg.decoder_id;
+      _bit_count = CHAR_BIT;
+      return bit();
+    case std::to_underlying(decup::Command::DeleteFlash):
+      if (size(bytes) != 4uz || bytes[1uz] != 0x55u) return 0u;
+      std::ranges::fill(flash, 0xFFu);
+      time += cfg.erase_latency * 1000uz;
+      return 2u;
+    case std::to_underlying(decup::Command::WriteFlash): {
+      if (size(bytes) != DECUP_MAX_PACKET_SIZE) return 0u;
+      auto const payload{bytes.subspan(4uz, size(bytes) - 4uz - 1uz)};
+      if (decup::crc8(payload, 0x55u) != bytes.back() || corrupt()) return 1u;
+      auto const block{static_cast<size_t>(bytes[2uz] | bytes[3uz] << 8u)};
+      write(block * size(payload), payload);
+      return 2u;
+    }
+    case std::to_underlying(decup::Command::CvSet): {
+      // Only baud rate feature requests get answered, by echoing the rate
+      if (!cfg.max_baud_rate || size(bytes) != 5uz ||
+          bytes[1uz] !=
+            std::to_underlying(decup::CvSetSubcommand::FeatureRequest) ||
+          bytes[2uz] != 0x01u)
+        return 0u;
+      auto const requested{bytes[3uz] * 9600u};
+      if (requested && requested <= cfg.max_baud_rate) {
+        _bits = bytes[3uz];
+        _next_baud_rate = requested;
+      } else _bits = 0u;
+      _bit_count = CHAR_BIT;
+      return bit();
+    }
+    default: return 0u;
+  }
+}
+
+// Bits are clocked out MSB first, a double pulse is a 1
+uint8_t SimDecoder::bit() {
+  auto const mask{static_cast<uint8_t>(0x80u >> (CHAR_BIT - _bit_count--))};
+  return _bits & mask ? 2u : 1u;
+}
+
+bool SimDecoder::corrupt() {
+  return cfg.nak_probability > 0.0 &&
+         std::bernoulli_distribution{cfg.nak_probability}(_rng);
+}
+
+void SimDecoder::write(size_t offset, std::span<uint8_t const> bytes) {
+  if (size(flash) < offset + size(bytes))
+    flash.resize(offset + size(bytes), 0xFFu);
+  std::ranges::copy(bytes, begin(flash) + static_cast<ptrdiff_t>(offset));
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include <vector>
+#include <ulf/decup_ein.hpp>
+
+// Simulated decoder with virtual-time wire model
+//
+// Every transmission advances a virtual clock by the UART time of its bytes
+// (start bit, 8 data bits, stop bits), followed either by ack latency and
+// pulses or by the full timeout if the decoder stays silent. The ZSU and ZPP
+// bootloaders are emulated far enough to rebuild the flashed image.
+struct SimDecoder : ulf::decup_ein::rx::Base {
+  struct Config {
+    uint8_t decoder_id{221u};
+    uint32_t baud_rate{38400u};
+    uint32_t max_baud_rate{};             // FeatureRequest unsupported if 0
+    uint32_t max_uart_baud_rate{115200u}; // Bridge UART limit
+    uint32_t ack_latency{100u};           // [us]
+    uint32_t pulse_time{50u};             // [us]
+    uint32_t erase_latency{200u};         // [ms]
+    double nak_probability{};
+    uint32_t seed{};
+  };
+
+  enum class Mode : uint8_t { Preamble, Zsu, Zpp };
+
+  SimDecoder();
+  explicit SimDecoder(Config config);
+
+  uint8_t answer(std::span<uint8_t const> bytes);
+  bool verify(std::span<uint8_t const> image) const;
+
+  Config cfg;
+  Mode mode{};
+  uint8_t stop_bits{1u};
+  uint32_t baud_rate{};         // Bridge UART, 0 for default
+  uint32_t decoder_baud_rate{}; // Decoder UART, 0 for default
+  uint64_t time{};              // [us]
+  size_t transmissions{};
+  size_t naks{};
+  size_t timeouts{};
+  std::vector<uint8_t> flash;
+  std::array<uint8_t, 1024uz> cvs{};
+
+private:
+  uint8_t transmit(std::span<uint8_t const> bytes, uint32_t timeout) final;
+  void config(uint8_t stop_bits) final;
+  bool configUart(uint8_t stop_bits, uint32_t baud_rate) final;
+
+  uint8_t zsu(std::span<uint8_t const> bytes);
+  uint8_t zpp(std::span<uint8_t const> bytes);
+  uint8_t bit();
+  bool corrupt();
+  void write(size_t offset, std::span<uint8_t const> bytes);
+
+  std::mt19937 _rng;
+  size_t _zsu_phase{};
+  size_t _block{};
+  uint8_t _bits{};
+  uint8_t _bit_count{};
+  uint32_t _next_baud_rate{};
+};
@@ -0,0 +1,181 @@
+#include <vector>
+#include "../utility.hpp"
+#include "rx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::AdaptiveTimeouts;
+using ulf::decup_ein::rx::Replay;
+using ulf::decup_ein::rx::Trace;
+
+namespace {
+
+// Clock advancing 10us each call
+uint32_t clock() {
+  static uint32_t us{};
+  return us += 10u;
+}
+
+// Replay trace while recording it again
+std::vector<uint8_t> replay(std::span<uint8_t const> data,
+                            size_t& mismatches,
+                            ulf::decup_ein::rx::State& state) {
+  // Records reserve room for their largest encoding
+  std::vector<uint8_t> buffer(size(data) + 64uz);
+  Trace trace{buffer};
+  Replay replay{data};
+  replay.trace(&trace);
+  mismatches = replay.run();
+  state = replay.state();
+  buffer.resize(size(trace.data()));
+  return buffer;
+}
+
+} // namespace
+
+TEST_F(RxTest, trace_replay_mx645) {
+  std::vector<uint8_t> buffer(1024uz * 1024uz);
+  Trace trace{buffer};
+  _mock.trace(&trace);
+
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu")
+    .ZsuPreamble(100uz)
+    .ZsuDecoderId(221u)
+    .ZsuBlockCount()
+    .ZsuSecurityByte1()
+    .ZsuSecurityByte2()
+    .ZsuBlocks();
+  EXPECT_FALSE(trace.overflow());
+
+  size_t mismatches{};
+  ulf::decup_ein::rx::State state{};
+  EXPECT_THAT(replay(trace.data(), mismatches, state),
+              ElementsAreArray(trace.data()));
+  EXPECT_EQ(mismatches, 0uz);
+  EXPECT_EQ(state, _mock.state());
+}
+
+TEST(AsyncRxTest, trace_replay_async) {
+  NiceMock<AsyncRxMock> mock;
+  std::array<uint8_t, 256uz> buffer{};
+  Trace trace{buffer};
+  mock.trace(&trace);
+
+  std::array<uint8_t, 3uz> const bytes{
+    std::to_underlying(decup::Command::Preamble0),
+    std::to_underlying(decup::Command::Preamble1),
+    std::to_underlying(decup::Command::Preamble0)};
+  std::array<uint8_t, 3uz> responses{};
+  mock.receive(bytes, responses);
+  mock.complete(2u);
+  mock.receive(std::span{bytes}.subspan(1uz), responses);
+  mock.complete(1u);
+  mock.receive(std::to_underlying(decup::Command::ReadDecoderType));
+  mock.reset();
+  mock.complete(2u);
+
+  size_t mismatches{};
+  ulf::decup_ein::rx::State state{};
+  EXPECT_THAT(replay(trace.data(), mismatches, state),
+              ElementsAreArray(trace.data()));
+  EXPECT_EQ(mismatches, 0uz);
+  EXPECT_EQ(state, mock.state());
+
+  // Changing a received byte changes the transmission
+  std::vector<uint8_t> data{cbegin(trace.data()), cend(trace.data())};
+  for (auto rest{trace.data()}; !empty(rest);) {
+    auto const offset{size(data) - size(rest)};
+    auto const record{Trace::read(rest)};
+    ASSERT_TRUE(record);
+    // Type, time and byte
+    if (record->type == Trace::Type::Receive)
+      data[offset + 2uz] = std::to_underlying(decup::Command::CvRead);
+  }
+  replay(data, mismatches, state);
+  EXPECT_GT(mismatches, 0uz);
+}
+
+TEST(AsyncRxTest, trace_replay_queued_response) {
+  NiceMock<AsyncRxMock> mock;
+  mock.options({.validate = true});
+  std::array<uint8_t, 1024uz> buffer{};
+  Trace trace{buffer};
+  mock.trace(&trace);
+
+  std::array<std::pair<uint8_t, uint8_t>, 4uz> const sequence{
+    {{221u, 2u}, {100u, 1u}, {0x55u, 1u}, {0xAAu, 1u}}};
+  for (auto const& [byte, pulse_count] : sequence) {
+    mock.receive(byte);
+    mock.complete(pulse_count);
+  }
+
+  // Second block is corrupt, its Nak gets flushed without consuming bytes
+  auto const block_size{decup::decoder_id2block_size(221u) + 2uz};
+  std::vector<uint8_t> blocks(2uz * block_size, 0x42u);
+  auto const first{std::span{blocks}.first(block_size)};
+  auto const second{std::span{blocks}.subspan(block_size)};
+  first[0uz] = 0u;
+  first.back() = decup::exor(first.first(block_size - 1uz));
+  second[0uz] = 1u;
+  second.back() = static_cast<uint8_t>(
+    decup::exor(second.first(block_size - 1uz)) ^ 0x01u);
+  std::array<uint8_t, 2uz> responses{};
+  mock.receive(blocks, responses);
+  mock.complete(2u);
+  auto const result{mock.receive(std::span<uint8_t const>{}, responses)};
+  ASSERT_EQ(result.out, 1uz);
+
+  // Host repeats second block, the response slot must still be free
+  second.back() ^= 0x01u;
+  mock.receive(second, std::span{responses}.first(1uz));
+  mock.complete(2u);
+
+  Replay replay{trace.data()};
+  replay.options({.validate = true});
+  EXPECT_EQ(replay.run(), 0uz);
+}
+
+TEST(AsyncRxTest, trace_replay_adaptive_timeouts) {
+  NiceMock<AsyncRxMock> mock;
+  AdaptiveTimeouts timeouts{99u, 50u, 1u};
+  timeouts.clock = clock;
+  mock.timeouts(&timeouts);
+  std::array<uint8_t, 256uz> buffer{};
+  Trace trace{buffer};
+  mock.trace(&trace);
+
+  // Later preambles get transmitted with adapted timeout
+  auto const max{decup::Timeouts::zpp_preamble};
+  EXPECT_CALL(mock, transmitAsync(_, _)).Times(AnyNumber());
+  EXPECT_CALL(mock, transmitAsync(_, Lt(max))).Times(AtLeast(1));
+  for (auto i{0uz}; i < 4uz; ++i) {
+    mock.receive(std::to_underlying(i % 2uz ? decup::Command::Preamble1
+                                            : decup::Command::Preamble0));
+    mock.complete(1u);
+  }
+
+  // Trace holds DECUP timeouts, replay doesn't need the same latencies
+  size_t mismatches{};
+  ulf::decup_ein::rx::State state{};
+  EXPECT_THAT(replay(trace.data(), mismatches, state),
+              ElementsAreArray(trace.data()));
+  EXPECT_EQ(mismatches, 0uz);
+}
+
+TEST_F(RxTest, trace_overflow) {
+  std::array<uint8_t, 32uz> buffer{};
+  Trace trace{buffer};
+  _mock.trace(&trace);
+
+  ZppPreamble(100uz);
+  EXPECT_TRUE(trace.overflow());
+  EXPECT_LE(size(trace.data()), size(buffer));
+
+  // Trace is a valid prefix
+  auto data{trace.data()};
+  while (Trace::read(data));
+  EXPECT_TRUE(empty(data));
+
+  trace.clear();
+  EXPECT_FALSE(trace.overflow());
+  EXPECT_TRUE(empty(trace.data()));
+}
@@ -0,0 +1,79 @@
+#include <vector>
+#include "rx_test.hpp"
+
+using namespace testing;
+
+namespace {
+
+// Walk through ZSU states up to the first block
+void enter_zsu_blocks(RxMock& mock, uint8_t decoder_id) {
+  EXPECT_CALL(mock, transmit(SizeIs(1uz), _)).WillRepeatedly(Return(1u));
+  EXPECT_CALL(mock, transmit(ElementsAre(decoder_id), _))
+    .WillOnce(Return(2u));
+  for (auto const byte : {decoder_id, uint8_t{100u}, uint8_t{0x55u},
+                          uint8_t{0xAAu}})
+    mock.receive(byte);
+}
+
+} // namespace
+
+TEST_F(RxTest, validate_zsu_block) {
+  _mock.options({.validate = true});
+  enter_zsu_blocks(_mock, 221u);
+
+  std::vector<uint8_t> block(decup::decoder_id2block_size(221u) + 2uz, 0x42u);
+  block.back() = decup::exor(std::span{block}.first(size(block) - 1uz));
+
+  // Corrupt block doesn't get transmitted
+  EXPECT_CALL(_mock, transmit(SizeIs(size(block)), _))
+    .Times(Exactly(1))
+    .WillOnce(Return(2u));
+  block[1uz] ^= 0x01u;
+  std::vector<uint8_t> responses(size(block));
+  auto result{_mock.receive(block, responses)};
+  EXPECT_EQ(result.out, 1uz);
+  EXPECT_EQ(responses[0uz], ulf::decup_ein::nak);
+
+  // Repeated block does
+  block[1uz] ^= 0x01u;
+  result = _mock.receive(block, responses);
+  EXPECT_EQ(result.out, 1uz);
+  EXPECT_EQ(responses[0uz], ulf::decup_ein::ack);
+}
+
+TEST_F(RxTest, validate_zpp_flash_packet) {
+  _mock.options({.validate = true});
+
+  std::vector<uint8_t> packet{0x05u, 0x55u, 0x00u, 0x00u};
+  packet.resize(DECUP_MAX_PACKET_SIZE - 1uz, 0x42u);
+  packet.push_back(decup::crc8(std::span{packet}.subspan(4uz), 0x55u));
+  packet.back() ^= 0xFFu;
+
+  EXPECT_CALL(_mock, transmit(_, _)).Times(Exactly(0));
+  for (auto i{0uz}; i < size(packet) - 1uz; ++i)
+    EXPECT_EQ(_mock.receive(packet[i]), std::nullopt);
+  EXPECT_EQ(_mock.receive(packet.back()), ulf::decup_ein::nak);
+}
+
+TEST_F(RxTest, validate_zpp_cvset_packet) {
+  _mock.options({.validate = true});
+
+  std::array<uint8_t, 4uz> const packet{
+    std::to_underlying(decup::Command::CvSet),
+    std::to_underlying(decup::CvSetSubcommand::CvWrite),
+    0x07u,
+    0x42u};
+
+  EXPECT_CALL(_mock, transmit(SizeIs(5uz), decup::Timeouts::zpp_cvset))
+    .Times(Exactly(1))
+    .WillOnce(Return(2u));
+
+  // Corrupt
+  for (auto const byte : packet) _mock.receive(byte);
+  EXPECT_EQ(_mock.receive(decup::crc8(packet, 0xAAu) ^ 0x01u),
+            ulf::decup_ein::nak);
+
+  // Valid
+  for (auto const byte : packet) _mock.receive(byte);
+  EXPECT_EQ(_mock.receive(decup::crc8(packet, 0xAAu)), ulf::decup_ein::ack);
+}
@@ -0,0 +1,71 @@
+#include <array>
+#include "rx_test.hpp"
+
+using namespace testing;
+using Cv = ulf::decup_ein::rx::AsyncBase::Cv;
+
+namespace {
+
+auto cvset_packet(decup::CvSetSubcommand subcommand,
+                  uint8_t data0,
+                  uint8_t data1) {
+  std::array<uint8_t, 5uz> packet{std::to_underlying(decup::Command::CvSet),
+                                  std::to_underlying(subcommand),
+                                  data0,
+                                  data1};
+  packet.back() = decup::crc8(std::span{packet}.first(4uz), 0xAAu);
+  return packet;
+}
+
+} // namespace
+
+TEST_F(RxTest, write_cvs) {
+  ZppPreamble(100uz);
+
+  std::array<Cv, 4uz> const cvs{
+    {{.address = 7u, .value = 8u},
+     {.address = 28u, .value = 2u},
+     {.address = 256u + 4u, .value = 42u},
+     {.address = 256u + 5u, .value = 43u}}};
+
+  {
+    using enum decup::CvSetSubcommand;
+    InSequence s;
+    for (auto const packet : {cvset_packet(CvWriteStart, 0u, 0u),
+                              cvset_packet(ChangePage, 0u, 0u),
+                              cvset_packet(CvWrite, 7u, 8u),
+                              cvset_packet(CvWrite, 28u, 2u),
+                              cvset_packet(ChangePage, 1u, 0u),
+                              cvset_packet(CvWrite, 4u, 42u),
+                              cvset_packet(CvWrite, 5u, 43u),
+                              cvset_packet(CvWriteEnd, 0u, 0u)})
+      EXPECT_CALL(
+        _mock, transmit(ElementsAreArray(packet), decup::Timeouts::zpp_cvset))
+        .WillOnce(Return(2u));
+  }
+
+  EXPECT_EQ(_mock.writeCvs(cvs), ulf::decup_ein::ack);
+  EXPECT_EQ(_mock.state(), ulf::decup_ein::rx::State::Zpp);
+}
+
+TEST_F(RxTest, write_cvs_retries) {
+  ZppPreamble(100uz);
+
+  std::array<Cv, 1uz> const cvs{{{.address = 7u, .value = 8u}}};
+
+  // Start acknowledged after one repetition, write never
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cvset))
+    .WillOnce(Return(1u))
+    .WillOnce(Return(2u))
+    .WillOnce(Return(2u))
+    .WillRepeatedly(Return(0u));
+
+  EXPECT_EQ(_mock.writeCvs(cvs, 2u), ulf::decup_ein::nak);
+  Mock::VerifyAndClearExpectations(&_mock);
+
+  // Next command works as usual
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cvset))
+    .Times(Exactly(2))
+    .WillRepeatedly(Return(2u));
+  EXPECT_EQ(_mock.writeCvs({}), ulf::decup_ein::ack);
+}
@@ -1,6 +1,7 @@
 #include <array>
 #include <ranges>
 #include <string_view>
+#include <utility>
 #include "../utility.hpp"
 #include "rx_test.hpp"
 
@@ -253,3 +254,56 @@ TEST_F(RxTest, zpp_cvset_change_page) {
 
   ZppCVSetChangePage();
 }
+
+TEST_F(RxTest, zpp_flash_write_skip_erased) {
+  Zpp(source_location_parent_path() / path);
+  _mock.options({.skip_erased = true});
+  ZppPreamble(100uz);
+
+  // Only the first of 4 pages contains data
+  _zpp.flash.assign(4uz * 256uz, 0xFFu);
+  _zpp.flash[0uz] = 0x00u;
+
+  // Skipping requires a successful erase
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_flash_write))
+    .Times(Exactly(4))
+    .WillRepeatedly(Return(2u));
+  ZppFlashWrite();
+  EXPECT_EQ(_mock.skipped(), 0uz);
+  Mock::VerifyAndClearExpectations(&_mock);
+
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_flash_erase))
+    .WillOnce(Return(2u));
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_flash_write))
+    .Times(Exactly(1))
+    .WillOnce(Return(2u));
+  ZppFlashErase().ZppFlashWrite();
+  EXPECT_EQ(_mock.skipped(), 3uz);
+}
+
+TEST_F(RxTest, zpp_high_speed_options) {
+  // Rates which don't fit into a FeatureRequest disable it
+  for (auto const& [high_speed, expected] :
+       {std::pair{115200u, 115200u},
+        std::pair{255u * 9600u, 255u * 9600u},
+        std::pair{256u * 9600u, 0u},
+        std::pair{100000u, 0u}}) {
+    _mock.options({.high_speed = high_speed});
+    EXPECT_EQ(_mock.options().high_speed, expected);
+  }
+}
+
+TEST_F(RxTest, zpp_high_speed_unsupported) {
+  Zpp(source_location_parent_path() / path);
+  _mock.options({.high_speed = 115200u});
+  ZppPreamble(100uz);
+
+  // Backend can't switch, so the decoder doesn't get asked
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_flash_erase))
+    .WillOnce(Return(2u));
+  EXPECT_CALL(_mock, transmit(_, decup::Timeouts::zpp_cvset)).Times(0);
+  _mock.receive(std::to_underlying(decup::Command::DeleteFlash));
+  _mock.receive(0x55u);
+  _mock.receive(0xFFu);
+  EXPECT_EQ(_mock.receive(0xFFu), ulf::decup_ein::ack);
+}
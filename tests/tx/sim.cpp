@@ -0,0 +1,204 @@
+#include "../rx/sim_decoder.hpp"
+#include "../utility.hpp"
+#include "tx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::Replay;
+using ulf::decup_ein::rx::Trace;
+using ulf::decup_ein::tx::ZppSession;
+using ulf::decup_ein::tx::ZsuSession;
+
+namespace {
+
+// UART time of bytes [us]
+uint64_t wire_time(size_t bytes, uint8_t stop_bits, uint32_t baud_rate) {
+  return bytes * (1uz + CHAR_BIT + stop_bits) * 1'000'000uz / baud_rate;
+}
+
+} // namespace
+
+TEST_F(RxTest, sim_zsu_mx645) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+  ZsuSession session{fws};
+  SimDecoder sim{{.decoder_id = 221u}};
+
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZsuSession::State::Done);
+  auto const fw{session.firmware()};
+  ASSERT_TRUE(fw);
+  EXPECT_TRUE(sim.verify(fw->bin));
+  EXPECT_EQ(sim.stop_bits, 2u);
+  EXPECT_EQ(sim.naks, 3uz); // Block count and security bytes
+
+  // Wall time is dominated by blocks on the wire
+  auto const blocks{session.progress().total};
+  auto const block_size{decup::decoder_id2block_size(fw->id) + 2uz};
+  auto const min_time{wire_time(blocks * block_size, 2u, sim.cfg.baud_rate)};
+  EXPECT_GT(sim.time, min_time);
+  EXPECT_LT(sim.time, min_time + min_time / 10uz);
+  RecordProperty("time_us", std::to_string(sim.time));
+}
+
+TEST_F(RxTest, sim_zsu_naks) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+
+  // Reference without any Naks
+  ZsuSession reference_session{fws};
+  SimDecoder reference{{.decoder_id = 221u}};
+  send(reference_session, reference);
+
+  ZsuSession session{fws, 100uz, 10u};
+  SimDecoder sim{
+    {.decoder_id = 221u, .nak_probability = 0.05, .seed = 42u}};
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZsuSession::State::Done);
+  EXPECT_TRUE(sim.verify(session.firmware()->bin));
+  EXPECT_GT(sim.naks, reference.naks);
+  EXPECT_EQ(sim.transmissions - reference.transmissions,
+            sim.naks - reference.naks);
+  EXPECT_GT(sim.time, reference.time);
+}
+
+TEST_F(RxTest, sim_zsu_stop_bits) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const bin{_zsu.firmwares.front().bin};
+
+  // Same binary, with 256 and 512 byte bootloader
+  std::array<uint64_t, 2uz> times{};
+  for (auto const decoder_id : {200u, 221u}) {
+    std::array<ulf::decup_ein::tx::Firmware, 1uz> const fws{
+      {{static_cast<uint8_t>(decoder_id), bin}}};
+    ZsuSession session{fws};
+    SimDecoder sim{{.decoder_id = static_cast<uint8_t>(decoder_id)}};
+    send(session, sim);
+    ASSERT_EQ(session.state(), ZsuSession::State::Done);
+    EXPECT_TRUE(sim.verify(bin));
+    EXPECT_EQ(sim.stop_bits, decoder_id == 200u ? 1u : 2u);
+    times[decoder_id == 221u] = sim.time;
+  }
+
+  // Second stop bit costs 10%
+  EXPECT_GT(times[1uz], times[0uz] + times[0uz] / 20uz);
+}
+
+TEST_F(RxTest, sim_zpp) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+  ZppSession session{_zpp.flash};
+  SimDecoder sim{{.nak_probability = 0.01, .seed = 7u}};
+
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(sim.verify(_zpp.flash));
+  EXPECT_EQ(sim.mode, SimDecoder::Mode::Zpp);
+  EXPECT_EQ(sim.stop_bits, 2u);
+  auto const min_time{wire_time(session.progress().total *
+                                  DECUP_MAX_PACKET_SIZE,
+                                2u,
+                                sim.cfg.baud_rate) +
+                      sim.cfg.erase_latency * 1000uz};
+  EXPECT_GT(sim.time, min_time);
+  RecordProperty("time_us", std::to_string(sim.time));
+}
+
+TEST_F(RxTest, sim_zpp_high_speed) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+
+  // Reference at DECUP baud rate
+  ZppSession reference_session{_zpp.flash};
+  SimDecoder reference;
+  send(reference_session, reference);
+
+  ZppSession session{_zpp.flash};
+  SimDecoder sim{{.max_baud_rate = 115200u}};
+  sim.options({.high_speed = 115200u});
+  std::vector<uint8_t> buffer(1024uz * 1024uz);
+  Trace trace{buffer};
+  sim.trace(&trace);
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(sim.verify(_zpp.flash));
+  EXPECT_EQ(sim.baud_rate, 115200u);
+  EXPECT_EQ(sim.decoder_baud_rate, 115200u);
+  EXPECT_EQ(sim.transmissions, reference.transmissions + CHAR_BIT);
+
+  // Replay switches along with the trace
+  ASSERT_FALSE(trace.overflow());
+  Replay replay{trace.data()};
+  replay.options({.high_speed = 115200u});
+  EXPECT_EQ(replay.run(), 0uz);
+  EXPECT_EQ(replay.state(), sim.state());
+
+  // Flash writes make up most of it and got 3x faster
+  EXPECT_LT(sim.time - sim.cfg.erase_latency * 1000uz,
+            (reference.time - sim.cfg.erase_latency * 1000uz) / 2uz);
+  RecordProperty("time_us", std::to_string(sim.time));
+}
+
+TEST_F(RxTest, sim_zpp_high_speed_fallback) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+
+  // Decoder which doesn't answer feature requests at all and one which Naks
+  // every bit since the requested baud rate is too fast
+  for (auto const max_baud_rate : {0u, 57600u}) {
+    ZppSession session{_zpp.flash};
+    SimDecoder sim{{.max_baud_rate = max_baud_rate}};
+    sim.options({.high_speed = 115200u});
+    send(session, sim);
+
+    ASSERT_EQ(session.state(), ZppSession::State::Done);
+    EXPECT_TRUE(sim.verify(_zpp.flash));
+    EXPECT_EQ(sim.baud_rate, 0u);
+    EXPECT_EQ(sim.decoder_baud_rate, 0u);
+  }
+
+  // Bridge which can't switch doesn't ask, replays don't either
+  ZppSession reference_session{_zpp.flash};
+  SimDecoder reference;
+  send(reference_session, reference);
+
+  ZppSession session{_zpp.flash};
+  SimDecoder sim{{.max_baud_rate = 115200u, .max_uart_baud_rate = 57600u}};
+  sim.options({.high_speed = 115200u});
+  std::vector<uint8_t> buffer(1024uz * 1024uz);
+  Trace trace{buffer};
+  sim.trace(&trace);
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(sim.verify(_zpp.flash));
+  EXPECT_EQ(sim.decoder_baud_rate, 0u);
+  EXPECT_EQ(sim.transmissions, reference.transmissions);
+
+  Replay replay{trace.data()};
+  replay.options({.high_speed = 115200u});
+  EXPECT_EQ(replay.run(), 0uz);
+}
+
+TEST_F(RxTest, sim_zpp_skip_erased) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+
+  // Reference transmitting every page
+  ZppSession reference_session{_zpp.flash};
+  SimDecoder reference;
+  send(reference_session, reference);
+
+  ZppSession session{_zpp.flash};
+  SimDecoder sim;
+  sim.options({.skip_erased = true});
+  send(session, sim);
+
+  ASSERT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_TRUE(sim.verify(_zpp.flash));
+  auto const pages{std::ranges::count_if(
+    _zpp.flash | std::views::chunk(256uz),
+    [](auto const& page) { return ulf::decup_ein::erased(page); })};
+  EXPECT_EQ(sim.skipped(), static_cast<size_t>(pages));
+  EXPECT_EQ(reference.transmissions - sim.transmissions, sim.skipped());
+  RecordProperty("skipped", std::to_string(sim.skipped()));
+}
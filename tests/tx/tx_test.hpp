@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include "../rx/rx_test.hpp"
+
+// Firmwares of ZSU file
+inline std::vector<ulf::decup_ein::tx::Firmware>
+firmwares(zsu::File const& zsu) {
+  std::vector<ulf::decup_ein::tx::Firmware> retval;
+  for (auto const& fw : zsu.firmwares)
+    retval.push_back({static_cast<uint8_t>(fw.id), fw.bin});
+  return retval;
+}
+
+// Send transfers of session to receiver until done or failed
+template<typename Session, typename Rx>
+void send(Session& session, Rx& rx) {
+  while (session.state() != Session::State::Done &&
+         session.state() != Session::State::Failed) {
+    std::optional<uint8_t> response;
+    for (auto const span : session.next())
+      for (auto const byte : span) response = rx.receive(byte);
+    session.response(response);
+  }
+}
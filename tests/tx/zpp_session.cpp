@@ -0,0 +1,26 @@
+#include "../utility.hpp"
+#include "tx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::tx::ZppSession;
+
+TEST_F(RxTest, tx_zpp_session) {
+  Zpp(source_location_parent_path() / "../../data/test.zpp");
+  ZppSession session{_zpp.flash};
+
+  // Decoder which fails the 2nd flash packet once
+  size_t packets{};
+  EXPECT_CALL(_mock, transmit(_, _)).WillRepeatedly(Return(0u));
+  EXPECT_CALL(_mock,
+              transmit(SizeIs(4uz), decup::Timeouts::zpp_flash_erase))
+    .WillOnce(Return(2u));
+  EXPECT_CALL(_mock,
+              transmit(SizeIs(DECUP_MAX_PACKET_SIZE),
+                       decup::Timeouts::zpp_flash_write))
+    .WillRepeatedly([&] { return ++packets == 2uz ? 1u : 2u; });
+
+  send(session, _mock);
+
+  EXPECT_EQ(session.state(), ZppSession::State::Done);
+  EXPECT_EQ(packets, session.progress().total + 1uz);
+}
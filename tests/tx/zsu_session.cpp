@@ -0,0 +1,81 @@
+#include "../utility.hpp"
+#include "tx_test.hpp"
+
+using namespace testing;
+using ulf::decup_ein::rx::State;
+using ulf::decup_ein::tx::ZsuSession;
+
+TEST_F(RxTest, tx_zsu_session) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+  ZsuSession session{fws};
+
+  // Decoder with ID 221 which fails the 4th block once
+  size_t blocks{};
+  EXPECT_CALL(_mock, transmit(_, _))
+    .WillRepeatedly([&](std::span<uint8_t const> bytes, uint32_t) -> uint8_t {
+      switch (_mock.state()) {
+        case State::ZsuDecoderId: return bytes[0uz] == 221u ? 2u : 0u;
+        case State::ZsuBlocks: return ++blocks == 4uz ? 1u : 2u;
+        default: return 1u;
+      }
+    });
+
+  send(session, _mock);
+
+  EXPECT_EQ(session.state(), ZsuSession::State::Done);
+  ASSERT_TRUE(session.firmware());
+  EXPECT_EQ(session.firmware()->id, 221u);
+  EXPECT_EQ(blocks, session.progress().total + 1uz);
+  EXPECT_EQ(session.progress().count, session.progress().total);
+}
+
+TEST_F(RxTest, tx_zsu_session_unknown_decoder) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+  ZsuSession session{fws};
+  send(session, _mock);
+  EXPECT_EQ(session.state(), ZsuSession::State::Failed);
+  EXPECT_FALSE(session.firmware());
+}
+
+TEST_F(RxTest, tx_zsu_session_resume) {
+  Zsu(source_location_parent_path() / "../../data/DS240307.zsu");
+  auto const fws{firmwares(_zsu)};
+
+  // Connection breaks after 100 blocks
+  bool connected{true};
+  size_t blocks{};
+  EXPECT_CALL(_mock, transmit(_, _))
+    .WillRepeatedly([&](std::span<uint8_t const> bytes, uint32_t) -> uint8_t {
+      switch (_mock.state()) {
+        case State::ZsuDecoderId: return bytes[0uz] == 221u ? 2u : 0u;
+        case State::ZsuBlocks:
+          if (connected && blocks == 100uz) return 0u;
+          ++blocks;
+          return 2u;
+        default: return 1u;
+      }
+    });
+  ZsuSession session{fws};
+  send(session, _mock);
+  ASSERT_EQ(session.state(), ZsuSession::State::Failed);
+
+  // Persist checkpoint, bridge gets reset on reconnect
+  auto const checkpoint{_mock.checkpoint()};
+  ASSERT_TRUE(checkpoint);
+  EXPECT_EQ(checkpoint->decoder_id, 221u);
+  EXPECT_EQ(checkpoint->block, 100u);
+  _mock.reset();
+  EXPECT_FALSE(_mock.checkpoint());
+  connected = false;
+
+  // Resume at first unacknowledged block
+  EXPECT_EQ(_mock.restore(*checkpoint), ulf::decup_ein::ack);
+  ZsuSession resumed{fws};
+  ASSERT_TRUE(resumed.resume(checkpoint->decoder_id, checkpoint->block));
+  EXPECT_EQ(resumed.progress().count, 100uz);
+  send(resumed, _mock);
+  EXPECT_EQ(resumed.state(), ZsuSession::State::Done);
+  EXPECT_EQ(blocks, resumed.progress().total);
+}